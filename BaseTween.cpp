@@ -6,27 +6,98 @@
 //
 
 #include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <new>
+#include <vector>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
 
 #include "BaseTween.h"
 
 #include "TweenManager.h"
+#include "Tween.h"
+#include "Timeline.h"
+#include "TweenEventQueue.h"
+#include "TweenSnapshot.h"
+#include "TweenStats.h"
+#include "TweenTracer.h"
 
 namespace TweenEngine
 {
+    // Seek in progress on this thread, and the events it coalesces. Each
+    // event links to the previous one of the same object, so that an
+    // object only looks through its own events.
+    static thread_local int seekDepth = 0;
+    static thread_local int seekPolicy = BaseTween::SEEK_SILENT;
+    static thread_local std::vector<TweenEvent> seekEvents;
+    static thread_local std::vector<int> seekEventLinks;
+    
+    bool BaseTween::isFastPathEnabled = true;
+    
+    BaseTween::BaseTween() : kind(KIND_CUSTOM)
+    {
+        static_assert(sizeof(BaseTween) - sizeof(Cold) <= HOT_BLOCK_SIZE, "BaseTween hot block doesn't fit HOT_BLOCK_SIZE");
+        assert(getHotStateSize() == (size_t)((char *)&cold - (char *)&currentTime));
+        
+        valuesStride = combinedAttrsCnt = waypointsCnt = 0;
+        equation = NULL;
+        values = NULL;
+        BaseTween::reset();
+    }
+    
+    /**
+     * Tweens and timelines are aligned on cache lines, so that the hot block
+     * never straddles two lines.
+     */
+    void *BaseTween::operator new(size_t size)
+    {
+        void *ptr = NULL;
+#if defined(_MSC_VER)
+        ptr = _aligned_malloc(size, CACHE_LINE_SIZE);
+#else
+        if (posix_memalign(&ptr, CACHE_LINE_SIZE, size) != 0) ptr = NULL;
+#endif
+        if (ptr == NULL) throw std::bad_alloc();
+        return ptr;
+    }
+    
+    void BaseTween::operator delete(void *ptr)
+    {
+#if defined(_MSC_VER)
+        _aligned_free(ptr);
+#else
+        ::free(ptr);
+#endif
+    }
+    
+    /**
+     * Enables the fast path of update(), taken by the objects playing inside
+     * an iteration. On by default. Turning it off gives the same results
+     * through the full update, to measure the fast path or rule it out while
+     * debugging. Must not be called during an update.
+     */
+    void BaseTween::setFastPathEnabled(bool isEnabled) { isFastPathEnabled = isEnabled; }
+    
     void BaseTween::reset()
     {
         step = -2;
 		repeatCnt = 0;
-		isIterationStep = isYoyoFlag = false;
+		flags = AUTO_REMOVE | AUTO_START;
         
 		delayStart = duration = repeatDelay = currentTime = deltaTime = 0;
-		isStartedFlag = isInitializedFlag = isFinishedFlag = isKilledFlag = isPausedFlag = false;
-        
-		callback = NULL;
-		callbackTriggers = TweenCallback::COMPLETE;
-		userData = NULL;
         
-		isAutoRemoveEnabled = isAutoStartEnabled = true;
+		cold.callback = NULL;
+		cold.callbackTriggers = TweenCallback::COMPLETE;
+		cold.eventQueue = NULL;
+		cold.id = 0;
+		cold.manager = NULL;
+		cold.dormantIndex = -1;
+		cold.parkedIndex = -1;
+		cold.seekEventIndex = -1;
+		cold.catchUpPolicy = CATCHUP_FIRE_ALL;
+		cold.userData = NULL;
     }
     
     //  API
@@ -54,7 +125,8 @@ namespace TweenEngine
     {
 		build();
 		currentTime = 0;
-		isStartedFlag = true;
+		setFlag(STARTED, true);
+		if (kind == KIND_TIMELINE) static_cast<Timeline *>(this)->startChildren();
 		return *this;
 	}
 
@@ -75,7 +147,7 @@ namespace TweenEngine
 	 * @param delay A duration.
 	 * @return The current object, for chaining instructions.
 	 */
-	BaseTween &BaseTween::delay(float delay)
+	BaseTween &BaseTween::delay(TweenTime delay)
     {
 		this->delayStart += delay;
 		return *this;
@@ -87,7 +159,9 @@ namespace TweenEngine
 	 */
 	void BaseTween::kill()
     {
-		isKilledFlag = true;
+		setFlag(KILLED, true);
+		if (hasFlag(PARKED)) cold.manager->unpark(this);
+		if (hasFlag(DORMANT)) cold.manager->wakeDormant(this);
 	}
     
 	/**
@@ -101,10 +175,13 @@ namespace TweenEngine
     
 	/**
 	 * Pauses the tween or timeline. Further update calls won't have any effect.
+	 * A managed object leaves the update loop at the next manager update, and
+	 * costs nothing per frame until it is resumed or killed.
 	 */
 	void BaseTween::pause()
     {
-		isPausedFlag = true;
+		if (hasFlag(PARKED)) cold.manager->unpark(this);
+		setFlag(PAUSED, true);
 	}
     
 	/**
@@ -112,7 +189,8 @@ namespace TweenEngine
 	 */
 	void BaseTween::resume()
     {
-		isPausedFlag = false;
+		setFlag(PAUSED, false);
+		if (hasFlag(DORMANT)) cold.manager->wakeDormant(this);
 	}
     
 	/**
@@ -123,9 +201,9 @@ namespace TweenEngine
 	 * @param delay A delay between each iteration.
 	 * @return The current tween or timeline, for chaining instructions.
 	 */
-	BaseTween &BaseTween::repeat(int count, float delay)
+	BaseTween &BaseTween::repeat(int count, TweenTime delay)
     {
-		if (isStartedFlag)
+		if (hasFlag(STARTED))
         {
             //throw new RuntimeException("You can't change the repetitions of a tween or timeline once it is started");
         }
@@ -133,7 +211,7 @@ namespace TweenEngine
         {
             repeatCnt = count;
             repeatDelay = delay >= 0 ? delay : 0;
-            isYoyoFlag = false;
+            setFlag(YOYO, false);
         }
 		return *this;
 	}
@@ -147,9 +225,9 @@ namespace TweenEngine
 	 * @param delay A delay before each repetition.
 	 * @return The current tween or timeline, for chaining instructions.
 	 */
-	BaseTween &BaseTween::repeatYoyo(int count, float delay)
+	BaseTween &BaseTween::repeatYoyo(int count, TweenTime delay)
     {
-		if (isStartedFlag)
+		if (hasFlag(STARTED))
         {
             //throw new RuntimeException("You can't change the repetitions of a tween or timeline once it is started");
         }
@@ -157,7 +235,7 @@ namespace TweenEngine
         {
             repeatCnt = count;
             repeatDelay = delay >= 0 ? delay : 0;
-            isYoyoFlag = true;
+            setFlag(YOYO, true);
         }
 		return *this;
 	}
@@ -171,7 +249,7 @@ namespace TweenEngine
 	 */
 	BaseTween &BaseTween::setCallback(TweenCallback *callback)
     {
-		this->callback = callback;
+		cold.callback = callback;
 		return *this;
 	}
     
@@ -203,7 +281,30 @@ namespace TweenEngine
 	 */
 	BaseTween &BaseTween::setCallbackTriggers(int flags)
     {
-		this->callbackTriggers = flags;
+		cold.callbackTriggers = flags;
+		return *this;
+	}
+    
+	/**
+	 * Changes how callbacks are fired when a big delta time makes a repeated
+	 * tween or timeline skip many whole iterations at once (app resumed from
+	 * background, seek...). Skipped iterations are always computed in
+	 * constant time, only the callbacks depend on the policy:
+	 * <p/>
+	 *
+	 * <b>CATCHUP_FIRE_ALL</b>: every START/END event of every skipped
+	 * iteration is fired, as if the iterations were played (default)<br/>
+	 * <b>CATCHUP_COALESCE</b>: each event type is fired once, through
+	 * {@link TweenCallback#onEvents()}, with the number of occurrences<br/>
+	 * <b>CATCHUP_LAST_ONLY</b>: each event type is fired once, as if a single
+	 * iteration was skipped
+	 *
+	 * @param policy One of the CATCHUP_* constants.
+	 * @return The current tween or timeline, for chaining instructions.
+	 */
+	BaseTween &BaseTween::setCatchUpPolicy(int policy)
+    {
+		cold.catchUpPolicy = policy;
 		return *this;
 	}
     
@@ -216,7 +317,7 @@ namespace TweenEngine
 	 */
 	BaseTween &BaseTween::setUserData(void *data)
     {
-		userData = data;
+		cold.userData = data;
 		return *this;
 	}
     
@@ -224,26 +325,38 @@ namespace TweenEngine
 	// Getters
 	// -------------------------------------------------------------------------
     
+	/**
+	 * Gets the kind of the object, one of the KIND_* constants. Tweens,
+	 * call/mark tweens and timelines are dispatched without virtual calls by
+	 * the update engine, user subclasses are KIND_CUSTOM.
+	 */
+	int BaseTween::getKind() { return kind; }
+    
 	/**
 	 * Gets the delay of the tween or timeline. Nothing will happen before
 	 * this delay.
 	 */
-	float BaseTween::getDelay() { return delayStart; }
+	TweenTime BaseTween::getDelay() { return delayStart; }
     
 	/**
 	 * Gets the duration of a single iteration.
 	 */
-	float BaseTween::getDuration() { return duration; }
+	TweenTime BaseTween::getDuration() { return duration; }
     
 	/**
 	 * Gets the number of iterations that will be played.
 	 */
     int BaseTween::getRepeatCount() { return repeatCnt; }
     
+	/**
+	 * Gets the policy used to fire callbacks of skipped iterations.
+	 */
+    int BaseTween::getCatchUpPolicy() { return cold.catchUpPolicy; }
+    
 	/**
 	 * Gets the delay occuring between two iterations.
 	 */
-	 float BaseTween::getRepeatDelay() { return repeatDelay; }
+	 TweenTime BaseTween::getRepeatDelay() { return repeatDelay; }
     
 	/**
 	 * Returns the complete duration, including initial delay and repetitions.
@@ -252,7 +365,7 @@ namespace TweenEngine
 	 * fullDuration = delay + duration + (repeatDelay + duration) * repeatCnt
 	 * </pre>
 	 */
-	float BaseTween::getFullDuration()
+	TweenTime BaseTween::getFullDuration()
     {
 		if (repeatCnt < 0) return -1;
 		return delayStart + duration + (repeatDelay + duration) * repeatCnt;
@@ -261,7 +374,13 @@ namespace TweenEngine
 	/**
 	 * Gets the attached data, or null if none.
 	 */
-	void *BaseTween::getUserData() { return userData; }
+	void *BaseTween::getUserData() { return cold.userData; }
+    
+	/**
+	 * Gets the id given by the manager this object was added to, or 0. See
+	 * {@link TweenManager#get()}.
+	 */
+	TweenId BaseTween::getId() { return cold.id; }
     
 	/**
 	 * Gets the id of the current step. Values are as follows:<br/>
@@ -277,68 +396,83 @@ namespace TweenEngine
 	/**
 	 * Gets the local time.
 	 */
-	float BaseTween::getCurrentTime() { return currentTime; }
+	TweenTime BaseTween::getCurrentTime() { return currentTime; }
     
 	/**
 	 * Returns true if the tween or timeline has been started.
 	 */
-	bool BaseTween::isStarted() { return isStartedFlag; }
+	bool BaseTween::isStarted() { return hasFlag(STARTED); }
     
 	/**
 	 * Returns true if the tween or timeline has been initialized. Starting
 	 * values for tweens are stored at initialization time. This initialization
 	 * takes place right after the initial delay, if any.
 	 */
-	bool BaseTween::isInitialized() { return isInitializedFlag; }
+	bool BaseTween::isInitialized() { return hasFlag(INITIALIZED); }
     
 	/**
 	 * Returns true if the tween is finished (i.e. if the tween has reached
 	 * its end or has been killed). If you don't use a TweenManager, you may
 	 * want to call {@link free()} to reuse the object later.
 	 */
-	bool BaseTween::isFinished() { return isFinishedFlag || isKilledFlag; }
+	bool BaseTween::isFinished() { return (flags & (FINISHED|KILLED)) != 0; }
     
 	/**
 	 * Returns true if the iterations are played as yoyo. Yoyo means that
 	 * every two iterations, the animation will be played backwards.
 	 */
-	bool BaseTween::isYoyo() { return isYoyoFlag; }
+	bool BaseTween::isYoyo() { return hasFlag(YOYO); }
     
 	/**
 	 * Returns true if the tween or timeline is currently paused.
 	 */
-	bool BaseTween::isPaused() { return isPausedFlag; }
+	bool BaseTween::isPaused() { return hasFlag(PAUSED); }
 
     void BaseTween::initializeOverride() {}
     
-    void BaseTween::updateOverride(int step, int lastStep, bool isIterationStep, float delta) {}
+    void BaseTween::updateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta) {}
     
     void BaseTween::forceToStart()
     {
         currentTime = -delayStart;
         step = -1;
-        isIterationStep = false;
-        if (isReverse(0)) forceEndValues();
-        else forceStartValues();
+        setFlag(ITERATION_STEP, false);
+        if (isReverse(0)) callForceEndValues();
+        else callForceStartValues();
     }
     
-    void BaseTween::forceToEnd(float time)
+    void BaseTween::forceToEnd(TweenTime time)
     {
         currentTime = time - getFullDuration();
         step = repeatCnt*2 + 1;
-        isIterationStep = false;
-        if (isReverse(repeatCnt*2)) forceStartValues();
-        else forceEndValues();
+        setFlag(ITERATION_STEP, false);
+        if (isReverse(repeatCnt*2)) callForceStartValues();
+        else callForceEndValues();
     }
     
     void BaseTween::callCallback(int type)
     {
-        if (callback != NULL && (callbackTriggers & type) > 0) callback->onEvent(type, this);
+        TweenTracer *tracer = TweenTracer::getCurrent();
+        if (tracer != NULL) tracer->traceObject(TweenTracer::getEventName(type), cold.id);
+        if (cold.callback != NULL && (cold.callbackTriggers & type) > 0) fireCallback(type, 1);
+    }
+    
+    bool BaseTween::isIterationStep()
+    {
+        return hasFlag(INITIALIZED) && hasFlag(ITERATION_STEP);
+    }
+    
+    /**
+     * Rewinds the local time to the beginning of the current iteration.
+     */
+    void BaseTween::restartIteration()
+    {
+        if (isIterationStep()) currentTime = 0;
     }
     
     bool BaseTween::isReverse(int step)
     {
-        return isYoyoFlag && abs(step%4) == 2;
+        return hasFlag(YOYO) && abs(step%4) == 2;
     }
     
     bool BaseTween::isValid(int step)
@@ -348,9 +482,122 @@ namespace TweenEngine
 
     void BaseTween::killTarget(TweenHandle tweenHandle)
     {
-        if (containsTarget(tweenHandle)) kill();
+        if (callContainsTarget(tweenHandle)) kill();
     }
 
+    // Custom kinds save their own state here, see TweenManager#snapshot()
+
+    void BaseTween::saveStateOverride(TweenSnapshotWriter &writer) {}
+
+    bool BaseTween::restoreStateOverride(TweenSnapshotReader &reader) { return true; }
+
+    // -------------------------------------------------------------------------
+	// Snapshots
+	// -------------------------------------------------------------------------
+
+    // The hot block past the vtable pointer, copied as it is in memory at an
+    // aligned position, then the state of the kind. The configuration set by
+    // the builder API (callback, accessor...) is not saved: a snapshot is
+    // restored on the same objects, see TweenManager#restore().
+
+    void BaseTween::saveState(TweenSnapshotWriter &writer)
+    {
+        writer.align(8);
+        writer.write(&currentTime, getHotStateSize());
+        switch (kind)
+        {
+            case KIND_TWEEN: static_cast<Tween *>(this)->Tween::saveStateOverride(writer); break;
+            case KIND_CALL: break;
+            default: saveStateOverride(writer); break;
+        }
+    }
+
+    bool BaseTween::restoreState(TweenSnapshotReader &reader)
+    {
+        if (!reader.align(8) || !reader.read(&currentTime, getHotStateSize())) return false;
+        switch (kind)
+        {
+            case KIND_TWEEN: return static_cast<Tween *>(this)->Tween::restoreStateOverride(reader);
+            case KIND_CALL: return true;
+            default: return restoreStateOverride(reader);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+	// Kind dispatch
+	// -------------------------------------------------------------------------
+    
+    // The engine only knows a closed set of kinds: these are called directly
+    // (and can be inlined by the compiler), the virtual interface is only
+    // used for user extensions (KIND_CUSTOM). Call/mark tweens have no
+    // target, so their accessor hooks are skipped.
+    
+    inline void BaseTween::callInitializeOverride()
+    {
+        switch (kind)
+        {
+            case KIND_TWEEN: static_cast<Tween *>(this)->Tween::initializeOverride(); break;
+            case KIND_CALL: break;
+            case KIND_TIMELINE: break;
+            default: initializeOverride(); break;
+        }
+    }
+    
+    inline void BaseTween::callUpdateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta)
+    {
+        switch (kind)
+        {
+            case KIND_TWEEN: static_cast<Tween *>(this)->Tween::updateOverride(step, lastStep, isIterationStep, delta); break;
+            case KIND_CALL: break;
+            case KIND_TIMELINE: static_cast<Timeline *>(this)->Timeline::updateOverride(step, lastStep, isIterationStep, delta); break;
+            default: updateOverride(step, lastStep, isIterationStep, delta); break;
+        }
+    }
+    
+    inline void BaseTween::callForceStartValues()
+    {
+        switch (kind)
+        {
+            case KIND_TWEEN: static_cast<Tween *>(this)->Tween::forceStartValues(); break;
+            case KIND_CALL: break;
+            case KIND_TIMELINE: static_cast<Timeline *>(this)->Timeline::forceStartValues(); break;
+            default: forceStartValues(); break;
+        }
+    }
+    
+    inline void BaseTween::callForceEndValues()
+    {
+        switch (kind)
+        {
+            case KIND_TWEEN: static_cast<Tween *>(this)->Tween::forceEndValues(); break;
+            case KIND_CALL: break;
+            case KIND_TIMELINE: static_cast<Timeline *>(this)->Timeline::forceEndValues(); break;
+            default: forceEndValues(); break;
+        }
+    }
+    
+    bool BaseTween::callContainsTarget(TweenHandle tweenHandle)
+    {
+        switch (kind)
+        {
+            case KIND_TWEEN: return static_cast<Tween *>(this)->Tween::containsTarget(tweenHandle);
+            case KIND_CALL: return false;
+            case KIND_TIMELINE: return static_cast<Timeline *>(this)->Timeline::containsTarget(tweenHandle);
+            default: return containsTarget(tweenHandle);
+        }
+    }
+    
+    void BaseTween::callFree()
+    {
+        switch (kind)
+        {
+            case KIND_TWEEN:
+            case KIND_CALL: static_cast<Tween *>(this)->Tween::free(); break;
+            case KIND_TIMELINE: static_cast<Timeline *>(this)->Timeline::free(); break;
+            default: free(); break;
+        }
+    }
+    
     // -------------------------------------------------------------------------
 	// Update engine
 	// -------------------------------------------------------------------------
@@ -365,15 +612,28 @@ namespace TweenEngine
 	 *
 	 * @param delta A delta time between now and the last call.
 	 */
-	void BaseTween::update(float delta)
+	void BaseTween::update(TweenTime delta)
     {
-		if (!isStartedFlag || isPausedFlag || isKilledFlag) return;
-        
+		if ((flags & (STARTED|PAUSED|KILLED)) != STARTED) return;
+
+		// Fast path: the tween is playing an iteration and the new time stays
+		// inside it, so no boundary can be crossed and no callback can fire.
+		if ((flags & (INITIALIZED|ITERATION_STEP)) == (INITIALIZED|ITERATION_STEP) && isFastPathEnabled)
+		{
+			TweenTime time = currentTime + delta;
+			if (time >= 0 && time <= duration)
+			{
+				currentTime = time;
+				callUpdateOverride(step, step, true, delta);
+				return;
+			}
+		}
+
 		deltaTime = delta;
         
-		if (!isInitializedFlag) initialize();
+		if (!hasFlag(INITIALIZED)) initialize();
         
-		if (isInitializedFlag)
+		if (hasFlag(INITIALIZED))
         {
 			testRelaunch();
 			updateStep();
@@ -384,14 +644,146 @@ namespace TweenEngine
 		deltaTime = 0;
 	}
 
+	/**
+	 * First phase of a two-phase update. Only touches this tween: when the
+	 * new time stays inside the current iteration of a plain tween, its
+	 * values are computed into its own buffer and left for the commit.
+	 * Anything that could fire a callback or reach another object is
+	 * deferred to commitUpdate() untouched.
+	 */
+	void BaseTween::computeUpdate(TweenTime delta)
+	{
+		if ((flags & (STARTED|PAUSED|KILLED)) != STARTED) return;
+
+		if ((flags & (INITIALIZED|ITERATION_STEP)) == (INITIALIZED|ITERATION_STEP)
+			&& (kind == KIND_TWEEN || kind == KIND_CALL))
+		{
+			TweenTime time = currentTime + delta;
+			if (time >= 0 && time <= duration)
+			{
+				currentTime = time;
+				if (kind == KIND_TWEEN && static_cast<Tween *>(this)->computeValues(step, delta)) setFlag(COMMIT_WRITE, true);
+				return;
+			}
+		}
+
+		setFlag(COMMIT_UPDATE, true);
+	}
+
+	/**
+	 * Second phase of a two-phase update, always called serially. Writes the
+	 * values computed by computeUpdate() or runs the deferred full update.
+	 */
+	void BaseTween::commitUpdate(TweenTime delta)
+	{
+		if (hasFlag(COMMIT_WRITE))
+		{
+			// A callback of a previous commit may have killed this tween
+			setFlag(COMMIT_WRITE, false);
+			if (!hasFlag(KILLED)) static_cast<Tween *>(this)->writeValues();
+		}
+		else if (hasFlag(COMMIT_UPDATE))
+		{
+			setFlag(COMMIT_UPDATE, false);
+			update(delta);
+		}
+	}
+
+	/**
+	 * Jumps to the given time, counted from the start of the object (delay
+	 * included), as a single update would, without firing the callbacks of
+	 * the events skipped on the way. Works on paused objects too, so that an
+	 * editor can scrub a paused animation. See {@link #seek(TweenTime, int)}.
+	 */
+	void BaseTween::seek(TweenTime time) { seek(time, SEEK_SILENT); }
+    
+	/**
+	 * Jumps to the given time, counted from the start of the object (delay
+	 * included). Repetitions are skipped in constant time, and a timeline
+	 * only reaches the children overlapping the span between its current
+	 * time and the new one, see Timeline.
+	 * <p/>
+	 *
+	 * <b>SEEK_SILENT</b>: the callbacks of the skipped events are not
+	 * fired<br/>
+	 * <b>SEEK_COALESCE</b>: each object fires each skipped event type once,
+	 * with the number of occurrences, see {@link TweenCallback#onEvents()},
+	 * after the seek
+	 *
+	 * @param time The new time, see {@link #getPosition()}.
+	 * @param policy One of the SEEK_* constants.
+	 */
+	void BaseTween::seek(TweenTime time, int policy)
+	{
+		if ((flags & (STARTED|KILLED)) != STARTED) return;
+		
+		// The children of a timeline are sought too, with the same policy
+		if (seekDepth++ == 0) seekPolicy = policy;
+		bool wasPaused = hasFlag(PAUSED);
+		setFlag(PAUSED, false);
+		update(time - getPosition());
+		setFlag(PAUSED, wasPaused);
+		if (--seekDepth > 0) return;
+		
+		// Events are fired once the whole seek is over. A callback may seek
+		// in turn, so the buffer is taken away meanwhile.
+		std::vector<TweenEvent> events;
+		events.swap(seekEvents);
+		seekEventLinks.clear();
+		for (size_t i=0; i<events.size(); i++) events[i].source->cold.seekEventIndex = -1;
+		for (size_t i=0; i<events.size(); i++) events[i].source->fireCallback(events[i].type, events[i].count);
+		events.clear();
+		if (events.capacity() > seekEvents.capacity()) events.swap(seekEvents);
+	}
+    
+	/**
+	 * Gets the time elapsed since the object was started, delay and
+	 * previous repetitions included, as given to seek().
+	 */
+	TweenTime BaseTween::getPosition()
+	{
+		if (!hasFlag(INITIALIZED) || step < 0) return (hasFlag(INITIALIZED) ? delayStart : 0) + currentTime;
+		
+		TweenTime time = delayStart + (step/2)*(duration + repeatDelay) + currentTime;
+		return step%2 == 0 ? time : time + duration;
+	}
+    
+    // Merges an event of a coalescing seek with the previous ones of the
+    // same object and type
+    void BaseTween::recordSeekEvent(int type, int count)
+    {
+        for (int i=cold.seekEventIndex; i>=0; i=seekEventLinks[i])
+        {
+            TweenEvent &event = seekEvents[i];
+            if (event.type != type) continue;
+            event.count += count;
+            return;
+        }
+        
+        TweenEvent event;
+        event.type = type;
+        event.count = count;
+        event.source = this;
+        event.handle = TweenManager::INVALID_TWEEN_HANDLE;
+        event.userData = cold.userData;
+        event.callback = cold.callback;
+        seekEvents.push_back(event);
+        seekEventLinks.push_back(cold.seekEventIndex);
+        cold.seekEventIndex = (int)seekEvents.size()-1;
+    }
+    
     void BaseTween::initialize() {
         if (currentTime+deltaTime >= delayStart)
         {
-            initializeOverride();
-            isInitializedFlag = true;
-            isIterationStep = true;
+            callInitializeOverride();
+            TWEEN_STATS_COUNT(initializedCnt, 1);
+            TweenTracer *tracer = TweenTracer::getCurrent();
+            if (tracer != NULL) tracer->traceObject("initialize", cold.id);
+            setFlag(INITIALIZED, true);
+            setFlag(ITERATION_STEP, true);
             step = 0;
             deltaTime -= delayStart-currentTime;
+            if (deltaTime < 0) deltaTime = 0; // rounding, would play backward
             currentTime = 0;
             callCallback(TweenCallback::BEGIN);
             callCallback(TweenCallback::START);
@@ -400,110 +792,233 @@ namespace TweenEngine
     
     void BaseTween::testRelaunch()
     {
-        if (!isIterationStep && repeatCnt >= 0 && step < 0 && currentTime+deltaTime >= 0)
+        if (!hasFlag(ITERATION_STEP) && repeatCnt >= 0 && step < 0 && currentTime+deltaTime >= 0)
         {
             assert(step == -1);
-            isIterationStep = true;
+            TWEEN_STATS_COUNT(crossingCnt, 1);
+            setFlag(ITERATION_STEP, true);
             step = 0;
-            float delta = 0-currentTime;
+            TweenTime delta = 0-currentTime;
             deltaTime -= delta;
             currentTime = 0;
             callCallback(TweenCallback::BEGIN);
             callCallback(TweenCallback::START);
-            updateOverride(step, step-1, isIterationStep, delta);
+            callUpdateOverride(step, step-1, true, delta);
             
         }
-        else if (!isIterationStep && repeatCnt >= 0 && step > repeatCnt*2 && currentTime+deltaTime < 0)
+        else if (!hasFlag(ITERATION_STEP) && repeatCnt >= 0 && step > repeatCnt*2 && currentTime+deltaTime < 0)
         {
             assert(step == repeatCnt*2 + 1);
-            isIterationStep = true;
+            TWEEN_STATS_COUNT(crossingCnt, 1);
+            setFlag(ITERATION_STEP, true);
             step = repeatCnt*2;
-            float delta = 0-currentTime;
+            TweenTime delta = 0-currentTime;
             deltaTime -= delta;
             currentTime = duration;
             callCallback(TweenCallback::BACK_BEGIN);
             callCallback(TweenCallback::BACK_START);
-            updateOverride(step, step+1, isIterationStep, delta);
+            callUpdateOverride(step, step+1, true, delta);
+        }
+    }
+    
+    /**
+     * Skips in constant time every whole iteration (plus its repeat delay)
+     * that the current delta would cross, leaving at least one iteration to
+     * the regular state machine so that boundary and completion handling
+     * stay unchanged. Only callbacks are fired for skipped iterations, since
+     * any value written in between would be overwritten anyway.
+     */
+    void BaseTween::catchUp()
+    {
+        TweenTime cycle = duration + repeatDelay;
+        if (cycle <= 0 || deltaTime == 0) return;
+        
+        bool isForward = deltaTime > 0;
+        int limit;
+        if (repeatCnt >= 0) limit = (isForward ? repeatCnt*2 - step : step) / 2;
+        else limit = (INT_MAX - abs(step)) / 2 - 1;
+        
+        TweenTime cycles = (isForward ? deltaTime : -deltaTime) / cycle - 1;
+        int count = cycles >= (TweenTime)limit ? limit : (int)cycles;
+        if (count < 1) return;
+        
+        int dir = isForward ? 1 : -1;
+        int firstType, secondType;
+        if (isForward)
+        {
+            firstType = hasFlag(ITERATION_STEP) ? TweenCallback::END : TweenCallback::START;
+            secondType = hasFlag(ITERATION_STEP) ? TweenCallback::START : TweenCallback::END;
+        }
+        else
+        {
+            firstType = hasFlag(ITERATION_STEP) ? TweenCallback::BACK_END : TweenCallback::BACK_START;
+            secondType = hasFlag(ITERATION_STEP) ? TweenCallback::BACK_START : TweenCallback::BACK_END;
+        }
+        
+        deltaTime -= dir*count*cycle;
+        TWEEN_STATS_COUNT(crossingCnt, 2*count);
+        
+        if (cold.callback == NULL || (cold.callbackTriggers & (firstType|secondType)) == 0)
+        {
+            step += dir*count*2;
+            return;
+        }
+        
+        // A seek coalesces anyway, skip the replay
+        switch (seekDepth > 0 ? CATCHUP_COALESCE : cold.catchUpPolicy)
+        {
+            case CATCHUP_COALESCE:
+                step += dir*count*2;
+                if ((cold.callbackTriggers & firstType) > 0) fireCallback(firstType, count);
+                if ((cold.callbackTriggers & secondType) > 0) fireCallback(secondType, count);
+                break;
+                
+            case CATCHUP_LAST_ONLY:
+                step += dir*count*2;
+                callCallback(firstType);
+                callCallback(secondType);
+                break;
+                
+            default:
+            {
+                // Replays the step and local time seen by the callbacks
+                TweenTime time = currentTime;
+                TweenTime firstTime = (firstType & (TweenCallback::END|TweenCallback::BACK_START)) > 0 ? duration : 0;
+                TweenTime secondTime = (secondType & (TweenCallback::END|TweenCallback::BACK_START)) > 0 ? duration : 0;
+                for (int i=0; i<count; i++)
+                {
+                    step += dir;
+                    currentTime = firstTime;
+                    callCallback(firstType);
+                    step += dir;
+                    currentTime = secondTime;
+                    callCallback(secondType);
+                }
+                currentTime = time;
+                break;
+            }
         }
     }
     
+    /**
+     * Calls the callback, or records the event if the manager defers them.
+     */
+    void BaseTween::fireCallback(int type, int count)
+    {
+        if (seekDepth > 0)
+        {
+            if (seekPolicy == SEEK_COALESCE) recordSeekEvent(type, count);
+            return;
+        }
+        
+        TWEEN_STATS_COUNT(callbackCnt, 1);
+        
+        if (cold.eventQueue != NULL)
+        {
+            TweenEvent event;
+            event.type = type;
+            event.count = count;
+            event.source = this;
+            event.handle = kind == KIND_TWEEN ? static_cast<Tween *>(this)->tweenHandle : TweenManager::INVALID_TWEEN_HANDLE;
+            event.userData = cold.userData;
+            event.callback = cold.callback;
+            if (cold.eventQueue->push(event)) return;
+        }
+        
+        // The callback may re-add the object under another id, read it before
+        TweenTracer *tracer = TweenTracer::getCurrent();
+        TweenId id = cold.id;
+        int64_t start = tracer != NULL ? TweenTracer::now() : 0;
+        
+        if (count > 1) cold.callback->onEvents(type, this, count);
+        else cold.callback->onEvent(type, this);
+        
+        if (tracer != NULL) tracer->traceCallback(type, id, start);
+    }
+    
     void BaseTween::updateStep()
     {
+        if (isValid(step)) catchUp();
+        
         while (isValid(step))
         {
-            if (!isIterationStep && currentTime+deltaTime <= 0)
+            if (!hasFlag(ITERATION_STEP) && currentTime+deltaTime <= 0)
             {
-                isIterationStep = true;
+                setFlag(ITERATION_STEP, true);
                 step -= 1;
+                TWEEN_STATS_COUNT(crossingCnt, 1);
                 
-                float delta = 0-currentTime;
+                TweenTime delta = 0-currentTime;
                 deltaTime -= delta;
                 currentTime = duration;
                 
-                if (isReverse(step)) forceStartValues();
-                else forceEndValues();
+                if (isReverse(step)) callForceStartValues();
+                else callForceEndValues();
                 callCallback(TweenCallback::BACK_START);
-                updateOverride(step, step+1, isIterationStep, delta);
+                callUpdateOverride(step, step+1, true, delta);
                 
             }
-            else if (!isIterationStep && currentTime+deltaTime >= repeatDelay)
+            else if (!hasFlag(ITERATION_STEP) && currentTime+deltaTime >= repeatDelay)
             {
-                isIterationStep = true;
+                setFlag(ITERATION_STEP, true);
                 step += 1;
+                TWEEN_STATS_COUNT(crossingCnt, 1);
                 
-                float delta = repeatDelay-currentTime;
+                TweenTime delta = repeatDelay-currentTime;
                 deltaTime -= delta;
                 currentTime = 0;
                 
-                if (isReverse(step)) forceEndValues(); else forceStartValues();
+                if (isReverse(step)) callForceEndValues(); else callForceStartValues();
                 callCallback(TweenCallback::START);
-                updateOverride(step, step-1, isIterationStep, delta);
+                callUpdateOverride(step, step-1, true, delta);
                 
             }
-            else if (isIterationStep && currentTime+deltaTime < 0)
+            else if (hasFlag(ITERATION_STEP) && currentTime+deltaTime < 0)
             {
-                isIterationStep = false;
+                setFlag(ITERATION_STEP, false);
                 step -= 1;
+                TWEEN_STATS_COUNT(crossingCnt, 1);
                 
-                float delta = 0-currentTime;
+                TweenTime delta = 0-currentTime;
                 deltaTime -= delta;
                 currentTime = 0;
                 
-                updateOverride(step, step+1, isIterationStep, delta);
+                callUpdateOverride(step, step+1, false, delta);
                 callCallback(TweenCallback::BACK_END);
                 
                 if (step < 0 && repeatCnt >= 0) callCallback(TweenCallback::BACK_COMPLETE);
                 else currentTime = repeatDelay;
                 
             }
-            else if (isIterationStep && currentTime+deltaTime > duration)
+            else if (hasFlag(ITERATION_STEP) && currentTime+deltaTime > duration)
             {
-                isIterationStep = false;
+                setFlag(ITERATION_STEP, false);
                 step += 1;
+                TWEEN_STATS_COUNT(crossingCnt, 1);
                 
-                float delta = duration-currentTime;
+                TweenTime delta = duration-currentTime;
                 deltaTime -= delta;
                 currentTime = duration;
                 
-                updateOverride(step, step-1, isIterationStep, delta);
+                callUpdateOverride(step, step-1, false, delta);
                 callCallback(TweenCallback::END);
                 
                 if (step > repeatCnt*2 && repeatCnt >= 0) callCallback(TweenCallback::COMPLETE);
                 currentTime = 0;
                 
             }
-            else if (isIterationStep)
+            else if (hasFlag(ITERATION_STEP))
             {
-                float delta = deltaTime;
+                TweenTime delta = deltaTime;
                 deltaTime -= delta;
                 currentTime += delta;
-                updateOverride(step, step, isIterationStep, delta);
+                callUpdateOverride(step, step, true, delta);
                 break;
                 
             }
             else
             {
-                float delta = deltaTime;
+                TweenTime delta = deltaTime;
                 deltaTime -= delta;
                 currentTime += delta;
                 break;
@@ -513,7 +1028,7 @@ namespace TweenEngine
     
     void BaseTween::testCompletion()
     {
-        isFinishedFlag = repeatCnt >= 0 && (step > repeatCnt*2 || step < 0);
+        setFlag(FINISHED, repeatCnt >= 0 && (step > repeatCnt*2 || step < 0));
     }
 
 
@@ -23,6 +23,7 @@
 #ifndef __BaseTween__
 #define __BaseTween__
 
+#include <cstddef>
 #include <cstdint>
 #include "TweenCallback.h"
 
@@ -30,93 +31,215 @@ namespace TweenEngine
 {
 	typedef uint64_t TweenHandle;
 
+    /**
+     * Identifies a tween or timeline added to a TweenManager. Encodes the
+     * index of its slot in the manager handle table (low 32 bits) and the
+     * generation of that slot (high 32 bits), so that an id goes stale as
+     * soon as the object is removed and its slot reused. 0 is never valid.
+     */
+    typedef uint64_t TweenId;
+
+    /**
+     * Type used for every time value (durations, delays, local times and
+     * deltas). Single precision by default; define TWEEN_ENGINE_DOUBLE_TIME
+     * for long-running repeated tweens that must stay phase-locked for hours,
+     * since float local times accumulate rounding error at every update and
+     * at every iteration boundary.
+     */
+#ifdef TWEEN_ENGINE_DOUBLE_TIME
+    typedef double TweenTime;
+#else
+    typedef float TweenTime;
+#endif
+
     class TweenManager;
+    class TweenEquation;
+    class TweenEventQueue;
+    class TweenSnapshotWriter;
+    class TweenSnapshotReader;
     
     class BaseTween
     {
     friend class TweenManager;
+    friend class Timeline;
 
+    public:
+        static const size_t CACHE_LINE_SIZE = 64;
+        
+        /**
+         * Maximum size of the hot block, i.e. the fields read by the update
+         * engine at every frame (including the vtable pointer). It fits a
+         * single cache line with the default float time base, two with the
+         * double one.
+         */
+        static const size_t HOT_BLOCK_SIZE = sizeof(TweenTime) == 4 ? CACHE_LINE_SIZE : 2*CACHE_LINE_SIZE;
+        
     private:
-        // General
+        // Flags
+        static const uint16_t ITERATION_STEP = 0x001;
+        static const uint16_t YOYO = 0x002;
+        static const uint16_t STARTED = 0x004;     // the object is started
+        static const uint16_t INITIALIZED = 0x008; // after the delay
+        static const uint16_t FINISHED = 0x010;    // all repetitions are done
+        static const uint16_t KILLED = 0x020;      // kill() was called
+        static const uint16_t PAUSED = 0x040;      // pause() was called
+        static const uint16_t AUTO_REMOVE = 0x080;
+        static const uint16_t AUTO_START = 0x100;
+        static const uint16_t COMMIT_WRITE = 0x200;  // computed values wait for their commit
+        static const uint16_t COMMIT_UPDATE = 0x400; // full update deferred to the commit
+        static const uint16_t PARKED = 0x800;        // waiting for its delay in a manager
+        static const uint16_t DORMANT = 0x1000;      // paused, out of the manager loop
+        static const uint16_t UNSAVED = 0x2000;      // left out of the snapshot being restored
+        static const uint16_t UNLOOPED = 0x4000;     // parked with its loop entry left to drop
+        static const uint16_t RELATIVE = 0x8000;     // tween targets to offset by the start values
+        
+        static bool isFastPathEnabled;
+        
+        // Hot block -- timings
+        TweenTime currentTime;
+        TweenTime deltaTime;
+        TweenTime repeatDelay;
+        
+    protected:
+        TweenTime delayStart;
+        TweenTime duration;
+        
+    private:
+        // Hot block -- general
         int step;
         int repeatCnt;
-        bool isIterationStep;
-        bool isYoyoFlag;
-        
-        // Timings
-        float repeatDelay;
-        float currentTime;
-        float deltaTime;
-        bool isStartedFlag;     // true when the object is started
-        bool isInitializedFlag; // true after the delay
-        bool isFinishedFlag;    // true when all repetitions are done
-        bool isKilledFlag;      // true if kill() was called
-        bool isPausedFlag;      // true if pause() was called
-        
-        // Misc
-        TweenCallback *callback;
-        int callbackTriggers;
-        void *userData;
+        uint16_t flags;
+        
+    protected:
+        uint8_t kind;
+        
+        // Hot block -- values of value tweens, kept here so that everything
+        // a Tween needs at every frame stays in the same cache line.
+        uint8_t valuesStride;
+        uint8_t combinedAttrsCnt;
+        uint8_t waypointsCnt;
+        TweenEquation *equation;
+        float *values;          // start values, then target values
+        
+    private:
+        // Cold block -- only touched on events and by the builder API
+        struct Cold
+        {
+            TweenCallback *callback;
+            void *userData;
+            int callbackTriggers;
+            int catchUpPolicy;
+            TweenEventQueue *eventQueue;
+            TweenId id;
+            TweenManager *manager;  // owner, while parked or dormant
+            int dormantIndex;       // position in the manager dormant set
+            int parkedIndex;        // position in the manager parked heap
+            int seekEventIndex;     // last event recorded by the seek in progress
+        };
+        Cold cold;
+
+        bool hasFlag(uint16_t flag) { return (flags & flag) != 0; }
+        void setFlag(uint16_t flag, bool value) { flags = value ? (flags | flag) : (flags & ~flag); }
 
         // Update
         void initialize();
         void testRelaunch();
+        void catchUp();
         void updateStep();
         void testCompletion();
+        void fireCallback(int type, int count);
+        void recordSeekEvent(int type, int count);
+        
+        // Two-phase update
+        void computeUpdate(TweenTime delta);
+        void commitUpdate(TweenTime delta);
+        
+        // Snapshots
+        void saveState(TweenSnapshotWriter &writer);
+        bool restoreState(TweenSnapshotReader &reader);
+        static size_t getHotStateSize() { return sizeof(BaseTween) - sizeof(Cold) - sizeof(void *); }
+        
+        // Kind dispatch
+        void callInitializeOverride();
+        void callUpdateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta);
+        void callForceStartValues();
+        void callForceEndValues();
+        bool callContainsTarget(TweenHandle tweenHandle);
+        void callFree();
         
     protected:
-        // Timings
-        float delayStart;
-        float duration;
-
         virtual void reset();
         virtual void forceStartValues() = 0;
         virtual void forceEndValues() = 0;
         virtual bool containsTarget(TweenHandle tweenHandle) = 0;
         virtual void initializeOverride();
-        virtual void updateOverride(int step, int lastStep, bool isIterationStep, float delta);
+        virtual void updateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta);
         virtual void forceToStart();
-        virtual void forceToEnd(float time);
+        virtual void forceToEnd(TweenTime time);
+        virtual void saveStateOverride(TweenSnapshotWriter &writer);
+        virtual bool restoreStateOverride(TweenSnapshotReader &reader);
 
         void callCallback(int type);
+        bool isIterationStep();
+        void restartIteration();
+        bool isRelative() { return hasFlag(RELATIVE); }
+        void setRelative(bool value) { setFlag(RELATIVE, value); }
         bool isReverse(int step);
         bool isValid(int step);
 
         void killTarget(TweenHandle tweenHandle);
 
     public:
+        static const int KIND_CUSTOM = 0;
+        static const int KIND_TWEEN = 1;
+        static const int KIND_CALL = 2;
+        static const int KIND_TIMELINE = 3;
+        
+        static const int CATCHUP_FIRE_ALL = 0;
+        static const int CATCHUP_COALESCE = 1;
+        static const int CATCHUP_LAST_ONLY = 2;
+        
+        static const int SEEK_SILENT = 0;
+        static const int SEEK_COALESCE = 1;
+
+        BaseTween();
         virtual ~BaseTween() {}
+        
+        static void *operator new(size_t size);
+        static void operator delete(void *ptr);
+        
+        static void setFastPathEnabled(bool isEnabled);
 
         virtual int getTweenCount() = 0;
         virtual int getTimelineCount() = 0;
 
-        // Package access
-        bool isAutoRemoveEnabled;
-        bool isAutoStartEnabled;
-
         virtual BaseTween &build();
         BaseTween &start();
         BaseTween &start(TweenManager &manager);
-        BaseTween &delay(float delay);
+        BaseTween &delay(TweenTime delay);
         void kill();
         virtual void free();
         void pause();
         void resume();
-        BaseTween &repeat(int count, float delay);
-        BaseTween &repeatYoyo(int count, float delay);
+        BaseTween &repeat(int count, TweenTime delay);
+        BaseTween &repeatYoyo(int count, TweenTime delay);
         BaseTween &setCallback(TweenCallback *callback);
         BaseTween &setCallbackTriggers(int flags);
+        BaseTween &setCatchUpPolicy(int policy);
         BaseTween &setUserData(void *data);
         
         // Getters
-        float getDelay();
-        float getDuration();
+        int getKind();
+        TweenTime getDelay();
+        TweenTime getDuration();
         int getRepeatCount();
-        float getRepeatDelay();
-        float getFullDuration();
+        int getCatchUpPolicy();
+        TweenTime getRepeatDelay();
+        TweenTime getFullDuration();
         void *getUserData();
+        TweenId getId();
         int getStep();
-        float getCurrentTime();
+        TweenTime getCurrentTime();
         bool isStarted();
         bool isInitialized();
         bool isFinished();
@@ -124,7 +247,10 @@ namespace TweenEngine
         bool isPaused();
         
         // Update
-        void update(float delta);
+        void update(TweenTime delta);
+        void seek(TweenTime time);
+        void seek(TweenTime time, int policy);
+        TweenTime getPosition();
 
     };
 
@@ -8,16 +8,54 @@
 /**
  * A light pool of objects that can be resused to avoid allocation.
  * Based on Nathan Sweet pool implementation
+ * <p/>
+ *
+ * Thread-safe and lock-free, based on Jeff Bonwick magazines: each thread
+ * caches up to two magazines (fixed arrays of free objects) and only goes to
+ * the global depot, a lock-free queue of full and empty magazines, once every
+ * MAGAZINE_SIZE get or free calls. Objects can be taken on a thread and freed
+ * on another one. The depot keeps at most DEPOT_CAPACITY full magazines,
+ * objects freed beyond that are deleted.
+ * <p/>
+ *
+ * A thread caches magazines of one pool per object type at a time, and gives
+ * them back to the depot when it exits. Pools are meant to live as long as
+ * the threads using them.
+ * <p/>
+ *
+ * Usage is counted per thread and added to the pool counters every
+ * MAGAZINE_SIZE calls, so that threads don't contend on them either: see
+ * getStats(). The idle objects can be trimmed on demand, or kept under a
+ * limit as they are freed, see setIdleLimit().
  */
 
 #ifndef __Pool__
 #define __Pool__
 
-#include <vector>
+#include <atomic>
+#include <cstddef>
+
+#include "RingBuffer.h"
 
 namespace TweenEngine
 {
-    
+    /**
+     * Usage counters of a pool, since it was created. Peaks are sampled
+     * when a thread adds its counts, so may be off by a few magazines when
+     * several threads share the pool.
+     */
+    struct PoolStats
+    {
+        size_t gets;        // objects taken
+        size_t frees;       // objects given back
+        size_t misses;      // objects created because the pool was empty
+        size_t trimmed;     // idle objects deleted by trims and limits
+        size_t live;        // objects taken and not given back
+        size_t peakLive;
+        size_t idle;        // objects waiting in the pool, see size()
+        size_t peakIdle;
+    };
+
     template<typename T>
     class PoolCallback
     {
@@ -25,18 +63,67 @@ namespace TweenEngine
         virtual void onPool(T *obj) = 0;
         virtual void onUnPool(T *obj) = 0;
     };
-    
+
     template<typename T>
     class Pool
     {
+    public:
+        static const int MAGAZINE_SIZE = 32;
+        static const int DEPOT_CAPACITY = 4096;
+
     private:
-        std::vector<T *> objects;
+        struct Magazine
+        {
+            int count;
+            T *objects[MAGAZINE_SIZE];
+        };
+
+        // Per-thread cache: objects are taken from and freed to 'loaded'
+        // first, 'previous' avoids trashing the depot around a boundary.
+        // Calls are counted here until the next fold().
+        struct Cache
+        {
+            Pool *owner;
+            Magazine *loaded;
+            Magazine *previous;
+            int getsCnt;
+            int freesCnt;
+            int peakLiveDelta;      // highest getsCnt - freesCnt
+
+            Cache() : owner(NULL), loaded(NULL), previous(NULL), getsCnt(0), freesCnt(0), peakLiveDelta(0) {}
+            ~Cache() { if (owner != NULL) owner->flush(*this); }
+        };
+
+        RingBuffer<Magazine *> fullMagazines;
+        RingBuffer<Magazine *> emptyMagazines;
+        std::atomic<int> depotObjectsCnt;
+        std::atomic<int> magazinesCnt;
+        std::atomic<int> idleLimit;
         PoolCallback<T> *callback;
-        
+
+        std::atomic<size_t> getsCnt;
+        std::atomic<size_t> freesCnt;
+        std::atomic<size_t> missesCnt;
+        std::atomic<size_t> trimmedCnt;
+        std::atomic<size_t> peakLive;
+        std::atomic<size_t> peakIdle;
+
+        static Cache &threadCache();
+        static void raise(std::atomic<size_t> &peak, size_t value);
+        Cache &bind();
+        void fold(Cache &cache);
+        void flush(Cache &cache);
+        int cachedCount(Cache &cache);
+        void deleteObjects(Magazine *magazine, int count);
+        Magazine *newMagazine();
+        Magazine *popEmpty();
+        void pushEmpty(Magazine *magazine);
+        void pushFull(Magazine *magazine);
+
     protected:
-        virtual ~Pool() {}
+        virtual ~Pool();
         virtual T *create()=0;
-        
+
     public:
         Pool(int initCapacity, PoolCallback<T> *callback);
         T *get();
@@ -44,55 +131,342 @@ namespace TweenEngine
         void clear();
         size_t size();
         void ensureCapacity(int minCapacity);
-        
+        PoolStats getStats();
+        void trim(int maxIdle);
+        void setIdleLimit(int maxIdle);
+
     };
-    
+
     // Implementation
     template <typename T>
-    Pool<T>::Pool(int initCapacity, PoolCallback<T> *cb) : objects(initCapacity), callback(cb)
+    Pool<T>::Pool(int initCapacity, PoolCallback<T> *cb) : fullMagazines(DEPOT_CAPACITY), emptyMagazines(DEPOT_CAPACITY), callback(cb)
+    {
+        depotObjectsCnt.store(0, std::memory_order_relaxed);
+        magazinesCnt.store(0, std::memory_order_relaxed);
+        idleLimit.store(-1, std::memory_order_relaxed);
+        getsCnt.store(0, std::memory_order_relaxed);
+        freesCnt.store(0, std::memory_order_relaxed);
+        missesCnt.store(0, std::memory_order_relaxed);
+        trimmedCnt.store(0, std::memory_order_relaxed);
+        peakLive.store(0, std::memory_order_relaxed);
+        peakIdle.store(0, std::memory_order_relaxed);
+        ensureCapacity(initCapacity);
+    }
+
+    template <typename T>
+    Pool<T>::~Pool()
+    {
+        clear();
+        Magazine *magazine;
+        while (emptyMagazines.pop(magazine)) delete magazine;
+    }
+
+    template <typename T>
+    typename Pool<T>::Cache &Pool<T>::threadCache()
+    {
+        static thread_local Cache cache;
+        return cache;
+    }
+
+    template <typename T>
+    void Pool<T>::raise(std::atomic<size_t> &peak, size_t value)
+    {
+        size_t current = peak.load(std::memory_order_relaxed);
+        while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    template <typename T>
+    typename Pool<T>::Cache &Pool<T>::bind()
+    {
+        Cache &cache = threadCache();
+        if (cache.owner != this)
+        {
+            if (cache.owner != NULL) cache.owner->flush(cache);
+            cache.owner = this;
+        }
+        return cache;
+    }
+
+    template <typename T>
+    int Pool<T>::cachedCount(Cache &cache)
+    {
+        int cnt = 0;
+        if (cache.loaded != NULL) cnt += cache.loaded->count;
+        if (cache.previous != NULL) cnt += cache.previous->count;
+        return cnt;
+    }
+
+    // Adds the counts of a thread to the pool ones
+    template <typename T>
+    void Pool<T>::fold(Cache &cache)
+    {
+        size_t gets = getsCnt.load(std::memory_order_relaxed);
+        size_t frees = freesCnt.load(std::memory_order_relaxed);
+        size_t live = gets > frees ? gets - frees : 0;
+        raise(peakLive, live + cache.peakLiveDelta);
+
+        int idle = depotObjectsCnt.load(std::memory_order_relaxed) + cachedCount(cache);
+        raise(peakIdle, idle > 0 ? (size_t)idle : 0);
+
+        getsCnt.fetch_add(cache.getsCnt, std::memory_order_relaxed);
+        freesCnt.fetch_add(cache.freesCnt, std::memory_order_relaxed);
+        cache.getsCnt = cache.freesCnt = cache.peakLiveDelta = 0;
+    }
+
+    template <typename T>
+    void Pool<T>::flush(Cache &cache)
+    {
+        fold(cache);
+        Magazine *magazines[] = {cache.loaded, cache.previous};
+        for (int i=0; i<2; i++)
+        {
+            if (magazines[i] == NULL) continue;
+            if (magazines[i]->count > 0) pushFull(magazines[i]);
+            else pushEmpty(magazines[i]);
+        }
+        cache.owner = NULL;
+        cache.loaded = cache.previous = NULL;
+    }
+
+    template <typename T>
+    typename Pool<T>::Magazine *Pool<T>::newMagazine()
+    {
+        Magazine *magazine = new Magazine;
+        magazine->count = 0;
+        magazinesCnt.fetch_add(1, std::memory_order_relaxed);
+        return magazine;
+    }
+
+    template <typename T>
+    typename Pool<T>::Magazine *Pool<T>::popEmpty()
     {
+        Magazine *magazine;
+        if (emptyMagazines.pop(magazine)) return magazine;
+        return newMagazine();
     }
-    
+
+    template <typename T>
+    void Pool<T>::pushEmpty(Magazine *magazine)
+    {
+        if (emptyMagazines.push(magazine)) return;
+        magazinesCnt.fetch_sub(1, std::memory_order_relaxed);
+        delete magazine;
+    }
+
+    template <typename T>
+    void Pool<T>::deleteObjects(Magazine *magazine, int count)
+    {
+        for (int i=magazine->count-count; i<magazine->count; i++) delete magazine->objects[i];
+        magazine->count -= count;
+        trimmedCnt.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    void Pool<T>::pushFull(Magazine *magazine)
+    {
+        int count = magazine->count;
+        int limit = idleLimit.load(std::memory_order_relaxed);
+        int depotCnt = depotObjectsCnt.fetch_add(count, std::memory_order_relaxed);
+        if ((limit < 0 || depotCnt + count <= limit) && fullMagazines.push(magazine)) return;
+
+        // Depot is full, give the memory back
+        depotObjectsCnt.fetch_sub(count, std::memory_order_relaxed);
+        deleteObjects(magazine, count);
+        pushEmpty(magazine);
+    }
+
     template <typename T>
     T *Pool<T>::get()
     {
 		T *obj = NULL;
-        if (objects.empty())
+        Cache &cache = bind();
+
+        if (cache.loaded == NULL || cache.loaded->count == 0)
         {
-            obj = create();
+            if (cache.previous != NULL && cache.previous->count > 0)
+            {
+                Magazine *magazine = cache.loaded;
+                cache.loaded = cache.previous;
+                cache.previous = magazine;
+            }
+            else
+            {
+                Magazine *magazine;
+                if (fullMagazines.pop(magazine))
+                {
+                    depotObjectsCnt.fetch_sub(magazine->count, std::memory_order_relaxed);
+                    if (cache.previous != NULL) pushEmpty(cache.previous);
+                    cache.previous = cache.loaded;
+                    cache.loaded = magazine;
+                }
+            }
+        }
+
+        if (cache.loaded != NULL && cache.loaded->count > 0)
+        {
+            obj = cache.loaded->objects[--cache.loaded->count];
         }
         else
         {
-            obj = objects.back();
-            objects.pop_back();
-            if (obj == NULL) obj = create();
+            obj = create();
+            missesCnt.fetch_add(1, std::memory_order_relaxed);
         }
+
+        int liveDelta = ++cache.getsCnt - cache.freesCnt;
+        if (liveDelta > cache.peakLiveDelta) cache.peakLiveDelta = liveDelta;
+        if (cache.getsCnt + cache.freesCnt >= MAGAZINE_SIZE) fold(cache);
+
 		if (callback != NULL) callback->onUnPool(obj);
 		return obj;
 	}
-    
+
     template <typename T>
 	void  Pool<T>::free(T *obj)
     {
 		if (obj == NULL) return;
-        
-        bool contains = (std::find(objects.begin(), objects.end(), obj) != objects.end());
-        
-		if (!contains)
+
+		if (callback != NULL) callback->onPool(obj);
+
+        Cache &cache = bind();
+        if (cache.loaded == NULL) cache.loaded = popEmpty();
+
+        if (cache.loaded->count == MAGAZINE_SIZE)
         {
-			if (callback != NULL) callback->onPool(obj);
-			objects.push_back(obj);
-		}
+            if (cache.previous != NULL && cache.previous->count == 0)
+            {
+                Magazine *magazine = cache.loaded;
+                cache.loaded = cache.previous;
+                cache.previous = magazine;
+            }
+            else
+            {
+                if (cache.previous != NULL) pushFull(cache.previous);
+                cache.previous = cache.loaded;
+                cache.loaded = popEmpty();
+            }
+        }
+
+        cache.loaded->objects[cache.loaded->count++] = obj;
+
+        cache.freesCnt++;
+        if (cache.getsCnt + cache.freesCnt >= MAGAZINE_SIZE) fold(cache);
 	}
-    
+
+    /**
+     * Deletes the objects of the depot and of the calling thread cache.
+     */
     template <typename T>
-	void  Pool<T>::clear() { objects.clear(); }
-    
+	void  Pool<T>::clear()
+    {
+        Cache &cache = threadCache();
+        if (cache.owner == this) flush(cache);
+
+        Magazine *magazine;
+        while (fullMagazines.pop(magazine))
+        {
+            depotObjectsCnt.fetch_sub(magazine->count, std::memory_order_relaxed);
+            deleteObjects(magazine, magazine->count);
+            pushEmpty(magazine);
+        }
+    }
+
+    /**
+     * Gets the number of objects in the depot and in the calling thread
+     * cache. Objects cached by other threads are not counted.
+     */
+    template <typename T>
+	size_t  Pool<T>::size()
+    {
+        int cnt = depotObjectsCnt.load(std::memory_order_relaxed);
+        Cache &cache = threadCache();
+        if (cache.owner == this) cnt += cachedCount(cache);
+        return cnt > 0 ? (size_t)cnt : 0;
+    }
+
+    /**
+     * Preallocates enough magazines to hold the given number of objects.
+     */
+    template <typename T>
+    void  Pool<T>::ensureCapacity(int minCapacity)
+    {
+        int magazinesNeeded = (minCapacity + MAGAZINE_SIZE - 1) / MAGAZINE_SIZE;
+        if (magazinesNeeded > DEPOT_CAPACITY) magazinesNeeded = DEPOT_CAPACITY;
+        while (magazinesCnt.load(std::memory_order_relaxed) < magazinesNeeded) pushEmpty(newMagazine());
+    }
+
+    /**
+     * Gets the usage counters of the pool, including the calls of the
+     * calling thread not added yet. Calls made by other threads since their
+     * last MAGAZINE_SIZE calls are not counted.
+     */
+    template <typename T>
+    PoolStats Pool<T>::getStats()
+    {
+        Cache &cache = threadCache();
+        if (cache.owner == this) fold(cache);
+
+        PoolStats stats;
+        stats.gets = getsCnt.load(std::memory_order_relaxed);
+        stats.frees = freesCnt.load(std::memory_order_relaxed);
+        stats.misses = missesCnt.load(std::memory_order_relaxed);
+        stats.trimmed = trimmedCnt.load(std::memory_order_relaxed);
+        stats.live = stats.gets > stats.frees ? stats.gets - stats.frees : 0;
+        stats.peakLive = peakLive.load(std::memory_order_relaxed);
+        stats.idle = size();
+        stats.peakIdle = peakIdle.load(std::memory_order_relaxed);
+        if (stats.peakLive < stats.live) stats.peakLive = stats.live;
+        if (stats.peakIdle < stats.idle) stats.peakIdle = stats.idle;
+        return stats;
+    }
+
+    /**
+     * Deletes idle objects until at most maxIdle of them are left in the
+     * depot and the calling thread cache, along with the magazines no longer
+     * needed to hold them. Objects cached by other threads are kept.
+     */
     template <typename T>
-	size_t  Pool<T>::size() { return objects.size(); }
-    
+    void Pool<T>::trim(int maxIdle)
+    {
+        if (maxIdle < 0) maxIdle = 0;
+        Cache &cache = threadCache();
+        if (cache.owner == this) flush(cache);
+
+        // Only the last magazine popped may keep objects
+        Magazine *magazine;
+        while (depotObjectsCnt.load(std::memory_order_relaxed) > maxIdle && fullMagazines.pop(magazine))
+        {
+            int excess = depotObjectsCnt.load(std::memory_order_relaxed) - maxIdle;
+            int count = excess < magazine->count ? excess : magazine->count;
+            depotObjectsCnt.fetch_sub(count, std::memory_order_relaxed);
+            deleteObjects(magazine, count);
+            if (magazine->count == 0) pushEmpty(magazine);
+            else if (!fullMagazines.push(magazine))
+            {
+                depotObjectsCnt.fetch_sub(magazine->count, std::memory_order_relaxed);
+                deleteObjects(magazine, magazine->count);
+                pushEmpty(magazine);
+            }
+        }
+
+        int magazinesNeeded = (maxIdle + MAGAZINE_SIZE - 1) / MAGAZINE_SIZE;
+        while (magazinesCnt.load(std::memory_order_relaxed) > magazinesNeeded && emptyMagazines.pop(magazine))
+        {
+            magazinesCnt.fetch_sub(1, std::memory_order_relaxed);
+            delete magazine;
+        }
+    }
+
+    /**
+     * Keeps the objects waiting in the depot under the given count: objects
+     * freed beyond it are deleted, a magazine at a time. A negative count,
+     * the default, only bounds them by DEPOT_CAPACITY magazines.
+     */
     template <typename T>
-    void  Pool<T>::ensureCapacity(int minCapacity) { objects.reserve(minCapacity); }
+    void Pool<T>::setIdleLimit(int maxIdle)
+    {
+        idleLimit.store(maxIdle, std::memory_order_relaxed);
+        if (maxIdle >= 0) trim(maxIdle);
+    }
 
 }
 
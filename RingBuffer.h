@@ -0,0 +1,154 @@
+//
+//  RingBuffer.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A bounded lock-free queue, preallocated at construction. Any number of
+ * threads may push and pop at the same time. Based on Dmitry Vyukov bounded
+ * queue: each slot carries a sequence number telling whether it is free or
+ * holds an item, so producers only contend on the head index and consumers
+ * on the tail one.
+ */
+
+#ifndef __RingBuffer__
+#define __RingBuffer__
+
+#include <atomic>
+#include <utility>
+
+namespace TweenEngine
+{
+    template<typename T>
+    class RingBuffer
+    {
+    private:
+        struct Slot
+        {
+            std::atomic<unsigned> sequence;
+            T item;
+        };
+
+        Slot *slots;
+        unsigned mask;
+
+        // Producers and consumers work on different cache lines
+        char padding1[64];
+        std::atomic<unsigned> head;     // next slot to push
+        char padding2[64];
+        std::atomic<unsigned> tail;     // next slot to pop
+
+        RingBuffer(const RingBuffer &);
+        RingBuffer &operator=(const RingBuffer &);
+
+    public:
+        RingBuffer(int capacity);
+        ~RingBuffer();
+
+        template<typename U> bool push(U &&item);
+        bool pop(T &item);
+        int capacity();
+    };
+
+    // Implementation
+
+    /**
+     * Creates a queue able to hold the given number of items, rounded up to
+     * the next power of two.
+     */
+    template <typename T>
+    RingBuffer<T>::RingBuffer(int capacity)
+    {
+        unsigned size = 2;
+        while ((int)size < capacity) size <<= 1;
+
+        slots = new Slot[size];
+        mask = size - 1;
+        for (unsigned i=0; i<size; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    RingBuffer<T>::~RingBuffer()
+    {
+        delete[] slots;
+    }
+
+    /**
+     * Adds an item. Safe to call from several threads at once. Returns false
+     * if the queue is full.
+     */
+    template <typename T>
+    template <typename U>
+    bool RingBuffer<T>::push(U &&item)
+    {
+        unsigned pos = head.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot &slot = slots[pos & mask];
+            int diff = (int)(slot.sequence.load(std::memory_order_acquire) - pos);
+
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+                {
+                    slot.item = std::forward<U>(item);
+                    slot.sequence.store(pos+1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Takes the oldest item out of the queue. Safe to call from several
+     * threads at once. Returns false if the queue is empty.
+     */
+    template <typename T>
+    bool RingBuffer<T>::pop(T &item)
+    {
+        unsigned pos = tail.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot &slot = slots[pos & mask];
+            int diff = (int)(slot.sequence.load(std::memory_order_acquire) - (pos+1));
+
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+                {
+                    item = std::move(slot.item);
+                    slot.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <typename T>
+    int RingBuffer<T>::capacity() { return (int)mask + 1; }
+}
+
+#endif /* defined(__RingBuffer__) */
@@ -0,0 +1,492 @@
+//
+//  Timeline.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A Timeline can be used to create complex animations made of sequences and
+ * parallel sets of Tweens.
+ * <p/>
+ *
+ * The following example will create an animation sequence composed of 5 parts:
+ * <p/>
+ *
+ * 1. First, opacity and scale are set to 0 (with Tween.set() calls).<br/>
+ * 2. Then, opacity and scale are animated in parallel.<br/>
+ * 3. Then, the animation is paused for 1s.<br/>
+ * 4. Then, position is animated to x=100.<br/>
+ * 5. Then, rotation is animated to 360°.
+ * <p/>
+ *
+ * This animation will be repeated 5 times, with a 500ms delay between each
+ * iteration:
+ * <br/><br/>
+ *
+ * <pre> {@code
+ * Timeline::createSequence()
+ *     .push(Tween::set(myObject, OPACITY).target(0))
+ *     .push(Tween::set(myObject, SCALE).target(0, 0))
+ *     .beginParallel()
+ *          .push(Tween::to(myObject, OPACITY, 0.5f).target(1).ease(Quad.INOUT))
+ *          .push(Tween::to(myObject, SCALE, 0.5f).target(1, 1).ease(Quad.INOUT))
+ *     .end()
+ *     .pushPause(1.0f)
+ *     .push(Tween::to(myObject, POS_X, 0.5f).target(100).ease(Quad.INOUT))
+ *     .push(Tween::to(myObject, ROTATION, 0.5f).target(360).ease(Quad.INOUT))
+ *     .repeat(5, 0.5f)
+ *     .start(myManager);
+ * }</pre>
+ *
+ * On build, the nested sequences and parallels are flattened into a single
+ * schedule of (start, end, child) entries sorted on time and indexed as an
+ * interval tree, so that an update or a seek only reaches the children
+ * whose span overlaps the time window it covers, in O(log n + k) whatever
+ * the number of children. Nested timelines that repeat or have a
+ * callback stay whole entries of the schedule.
+ *
+ * @see Tween
+ * @see TweenManager
+ * @see TweenCallback
+ * @author Aurelien Ribon | http://www.aurelienribon.com/
+ */
+
+#include <assert.h>
+#include <algorithm>
+
+#include "Timeline.h"
+#include "TimelinePool.h"
+#include "TweenSnapshot.h"
+
+namespace TweenEngine
+{
+    TimelinePool &Timeline::pool = *(new TimelinePool());
+
+	/**
+	 * Used for debug purpose. Gets the current number of empty timelines that
+	 * are waiting in the Timeline pool, not counting the ones cached by other
+	 * threads.
+	 */
+	size_t Timeline::getPoolSize() { return pool.size(); }
+
+	/**
+	 * Increases the minimum capacity of the pool. Capacity defaults to 10.
+	 */
+	void Timeline::ensurePoolCapacity(int minCapacity) { pool.ensureCapacity(minCapacity); }
+
+	/**
+	 * Gets the usage counters of the Timeline pool: peak usage and misses
+	 * tell how to size {@link #ensurePoolCapacity()}.
+	 */
+	PoolStats Timeline::getPoolStats() { return pool.getStats(); }
+
+	/**
+	 * Deletes idle timelines of the pool, keeping at most the given number.
+	 */
+	void Timeline::trimPool(int maxIdle) { pool.trim(maxIdle); }
+
+	/**
+	 * Keeps at most the given number of idle timelines in the pool, the ones
+	 * freed beyond are deleted. Unlimited if negative, the default.
+	 */
+	void Timeline::setPoolIdleLimit(int maxIdle) { pool.setIdleLimit(maxIdle); }
+
+	// -------------------------------------------------------------------------
+	// Static -- factories
+	// -------------------------------------------------------------------------
+
+	/**
+	 * Creates a new timeline with a 'sequence' behavior. Its children will be
+	 * delayed so that they are triggered one after the other.
+	 */
+	Timeline &Timeline::createSequence()
+    {
+		Timeline &timeline = *(pool.get());
+		timeline.setup(SEQUENCE);
+		return timeline;
+	}
+
+	/**
+	 * Creates a new timeline with a 'parallel' behavior. Its children will be
+	 * triggered all at once.
+	 */
+	Timeline &Timeline::createParallel()
+    {
+		Timeline &timeline = *(pool.get());
+		timeline.setup(PARALLEL);
+		return timeline;
+	}
+
+	// -------------------------------------------------------------------------
+	// Setup
+	// -------------------------------------------------------------------------
+
+    Timeline::Timeline()
+    {
+        isPooled = false;
+        reset();
+    }
+
+    void Timeline::reset()
+    {
+        BaseTween::reset();
+
+        kind = KIND_TIMELINE;
+        children.clear();
+        entries.clear();
+        current = this;
+        parent = NULL;
+        mode = SEQUENCE;
+        isBuilt = false;
+        childrenTime = 0;
+    }
+
+    void Timeline::setup(int mode)
+    {
+        this->mode = mode;
+        this->current = this;
+    }
+
+	// -------------------------------------------------------------------------
+	// Public API
+	// -------------------------------------------------------------------------
+
+	/**
+	 * Adds a Tween to the current timeline.
+	 *
+	 * @return The current timeline, for chaining instructions.
+	 */
+	Timeline &Timeline::push(Tween &tween)
+    {
+		assert(!isBuilt);
+		current->children.push_back(&tween);
+		return *this;
+	}
+
+	/**
+	 * Nests a Timeline in the current one.
+	 *
+	 * @return The current timeline, for chaining instructions.
+	 */
+	Timeline &Timeline::push(Timeline &timeline)
+    {
+		assert(!isBuilt);
+		assert(timeline.current == &timeline); // a few 'end()' calls are missing in the pushed timeline
+		timeline.parent = current;
+		current->children.push_back(&timeline);
+		return *this;
+	}
+
+	/**
+	 * Adds a pause to the timeline. The pause may be negative if you want to
+	 * overlap the preceding and following children.
+	 *
+	 * @param time A positive or negative duration.
+	 * @return The current timeline, for chaining instructions.
+	 */
+	Timeline &Timeline::pushPause(TweenTime time)
+    {
+		assert(!isBuilt);
+		current->children.push_back(&Tween::mark().delay(time));
+		return *this;
+	}
+
+	/**
+	 * Starts a nested timeline with a 'sequence' behavior. Don't forget to
+	 * call {@link end()} to close this nested timeline.
+	 *
+	 * @return The current timeline, for chaining instructions.
+	 */
+	Timeline &Timeline::beginSequence()
+    {
+		assert(!isBuilt);
+		Timeline &timeline = *(pool.get());
+		timeline.parent = current;
+		timeline.mode = SEQUENCE;
+		current->children.push_back(&timeline);
+		current = &timeline;
+		return *this;
+	}
+
+	/**
+	 * Starts a nested timeline with a 'parallel' behavior. Don't forget to
+	 * call {@link end()} to close this nested timeline.
+	 *
+	 * @return The current timeline, for chaining instructions.
+	 */
+	Timeline &Timeline::beginParallel()
+    {
+		assert(!isBuilt);
+		Timeline &timeline = *(pool.get());
+		timeline.parent = current;
+		timeline.mode = PARALLEL;
+		current->children.push_back(&timeline);
+		current = &timeline;
+		return *this;
+	}
+
+	/**
+	 * Closes the last nested timeline.
+	 *
+	 * @return The current timeline, for chaining instructions.
+	 */
+	Timeline &Timeline::end()
+    {
+		assert(!isBuilt);
+		assert(current != this); // nothing to end
+		current = current->parent;
+		return *this;
+	}
+
+	/**
+	 * Gets the children of the current timeline, as they were pushed. Must
+	 * not be modified once the timeline is built.
+	 */
+	std::vector<BaseTween *> &Timeline::getChildren() { return current->children; }
+
+	// -------------------------------------------------------------------------
+	// Overrides
+	// -------------------------------------------------------------------------
+
+    int Timeline::getTweenCount()
+    {
+		int cnt = 0;
+		for (int i=0, n=(int)children.size(); i<n; i++) cnt += children[i]->getTweenCount();
+		return cnt;
+	}
+
+    int Timeline::getTimelineCount()
+    {
+		int cnt = 1;
+		for (int i=0, n=(int)children.size(); i<n; i++) cnt += children[i]->getTimelineCount();
+		return cnt;
+	}
+
+	/**
+	 * Flattens the nested timelines into the schedule and computes the
+	 * duration. Objects with infinite repetitions can't be pushed.
+	 */
+	Timeline &Timeline::build()
+    {
+		if (isBuilt) return *this;
+
+		entries.clear();
+		duration = schedule(entries, 0);
+
+		// Stable on the schedule order, without the buffer std::stable_sort
+		// allocates
+		std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+		{
+			return a.activeStart < b.activeStart || (a.activeStart == b.activeStart && a.order < b.order);
+		});
+		if (!entries.empty()) buildTree(0, (int)entries.size());
+
+		isBuilt = true;
+		return *this;
+	}
+
+	void Timeline::free()
+    {
+		if (isPooled) return;
+		isPooled = true;
+
+		for (int i=(int)children.size()-1; i>=0; i--) children[i]->callFree();
+		pool.free(this);
+	}
+
+    /**
+     * Nested timelines played once and without callback are merged in the
+     * schedule of their parent, the other ones are updated as a whole.
+     */
+    bool Timeline::isFlattened()
+    {
+        return parent != NULL && getRepeatCount() == 0 && cold.callback == NULL;
+    }
+
+    /**
+     * Appends the children to the schedule, the first one starting at the
+     * given offset, and returns the time they span.
+     */
+    TweenTime Timeline::schedule(std::vector<Entry> &schedule, TweenTime offset)
+    {
+        TweenTime length = 0;
+
+        for (int i=0, n=(int)children.size(); i<n; i++)
+        {
+            BaseTween *obj = children[i];
+            assert(obj->getRepeatCount() >= 0);
+
+            TweenTime start = mode == SEQUENCE ? offset + length : offset;
+            TweenTime fullDuration;
+
+            Timeline *timeline = obj->kind == KIND_TIMELINE ? static_cast<Timeline *>(obj) : NULL;
+            if (timeline != NULL && timeline->isFlattened())
+            {
+                timeline->duration = timeline->schedule(schedule, start + timeline->delayStart);
+                timeline->isBuilt = true;
+                fullDuration = timeline->getFullDuration();
+            }
+            else
+            {
+                obj->build();
+                fullDuration = obj->getFullDuration();
+
+                Entry entry;
+                entry.start = start;
+                entry.activeStart = start + obj->delayStart;
+                entry.end = start + fullDuration;
+                entry.time = start;
+                entry.child = obj;
+                entry.order = (int)schedule.size();
+                schedule.push_back(entry);
+            }
+
+            length = mode == SEQUENCE ? length + fullDuration : std::max(length, fullDuration);
+        }
+
+        return length;
+    }
+
+    /**
+     * The sorted entries are read as a balanced search tree, the middle of
+     * each range being the root of its subtree. Computes the latest end of
+     * each subtree.
+     */
+    TweenTime Timeline::buildTree(int first, int last)
+    {
+        int mid = (first + last) / 2;
+        TweenTime maxEnd = entries[mid].end;
+        if (first < mid) maxEnd = std::max(maxEnd, buildTree(first, mid));
+        if (mid+1 < last) maxEnd = std::max(maxEnd, buildTree(mid+1, last));
+        entries[mid].maxEnd = maxEnd;
+        return maxEnd;
+    }
+
+    /**
+     * Calls visit on every entry whose span overlaps [lo, hi], in time order
+     * or reversed. Subtrees ending before lo are pruned, as well as the
+     * ones starting after hi: the first entry of a range starts first.
+     */
+    template<typename Visitor>
+    void Timeline::visitEntries(int first, int last, TweenTime lo, TweenTime hi, bool isBackward, Visitor &visit)
+    {
+        if (first >= last || entries[first].activeStart > hi) return;
+        int mid = (first + last) / 2;
+        Entry &entry = entries[mid];
+        if (entry.maxEnd < lo) return;
+
+        if (isBackward) visitEntries(mid+1, last, lo, hi, isBackward, visit);
+        else visitEntries(first, mid, lo, hi, isBackward, visit);
+
+        if (entry.activeStart <= hi && entry.end >= lo) visit(entry);
+
+        if (isBackward) visitEntries(first, mid, lo, hi, isBackward, visit);
+        else visitEntries(mid+1, last, lo, hi, isBackward, visit);
+    }
+
+    void Timeline::startChildren()
+    {
+        for (int i=0, n=(int)entries.size(); i<n; i++)
+        {
+            entries[i].child->start();
+            entries[i].time = entries[i].start;
+        }
+        childrenTime = 0;
+    }
+
+    /**
+     * Brings every child whose span overlaps the window between the last
+     * time and the new one to the new time, in time order (reversed when
+     * going backward). The other children would not change, so they are
+     * left behind, and catch up in one update once the window reaches them.
+     */
+    void Timeline::updateChildren(TweenTime time)
+    {
+        auto update = [time](Entry &entry)
+        {
+            entry.child->update(time - entry.time);
+            entry.time = time;
+        };
+        visitEntries(0, (int)entries.size(), std::min(childrenTime, time), std::max(childrenTime, time), time < childrenTime, update);
+        childrenTime = time;
+    }
+
+    void Timeline::updateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta)
+    {
+        // Leaving an iteration, children are pushed past its bounds so that
+        // the ones ending right on them complete too
+        if (!isIterationStep)
+        {
+            bool isEndReached = (step > lastStep) != isReverse(lastStep);
+            updateChildren(isEndReached ? duration + 1 : -1);
+            return;
+        }
+
+        updateChildren(isReverse(step) ? duration - getCurrentTime() : getCurrentTime());
+    }
+
+    // Children that never played have nothing to rewind, they catch up with
+    // their next update
+
+    void Timeline::forceStartValues()
+    {
+        for (int i=(int)entries.size()-1; i>=0; i--)
+        {
+            Entry &entry = entries[i];
+            if (!entry.child->isInitialized()) continue;
+            entry.child->forceToStart();
+            entry.time = entry.start;
+        }
+        childrenTime = 0;
+    }
+
+    void Timeline::forceEndValues()
+    {
+        for (int i=0, n=(int)entries.size(); i<n; i++)
+        {
+            Entry &entry = entries[i];
+            if (!entry.child->isInitialized()) continue;
+            entry.child->forceToEnd(duration - entry.start);
+            entry.time = duration;
+        }
+        childrenTime = duration;
+    }
+
+    // Children are saved with the time they were last updated to, the layout
+    // of the schedule is fixed once built
+
+    void Timeline::saveStateOverride(TweenSnapshotWriter &writer)
+    {
+        writer.write(childrenTime);
+        writer.write((uint32_t)entries.size());
+        for (int i=0, n=(int)entries.size(); i<n; i++)
+        {
+            writer.write(entries[i].time);
+            entries[i].child->saveState(writer);
+        }
+    }
+
+    bool Timeline::restoreStateOverride(TweenSnapshotReader &reader)
+    {
+        uint32_t entriesCnt;
+        reader.read(childrenTime);
+        if (!reader.read(entriesCnt) || entriesCnt != entries.size()) return reader.fail();
+        
+        for (int i=0, n=(int)entries.size(); i<n; i++)
+        {
+            reader.read(entries[i].time);
+            if (!entries[i].child->restoreState(reader)) return false;
+        }
+        return true;
+    }
+
+    bool Timeline::containsTarget(TweenHandle tweenHandle)
+    {
+        for (int i=0, n=(int)entries.size(); i<n; i++)
+        {
+            if (entries[i].child->callContainsTarget(tweenHandle)) return true;
+        }
+        return false;
+    }
+}
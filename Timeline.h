@@ -0,0 +1,98 @@
+//
+//  Timeline.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#ifndef __Timeline__
+#define __Timeline__
+
+#include <vector>
+#include "BaseTween.h"
+#include "Tween.h"
+
+namespace TweenEngine
+{
+    class TimelinePool;
+    class TimelinePoolCallback;
+
+    class Timeline : public BaseTween
+    {
+        friend class BaseTween;
+        friend class TimelinePoolCallback;
+
+    private:
+        static const int SEQUENCE = 0;
+        static const int PARALLEL = 1;
+
+        // A child of the flat schedule built from the nested sequences and
+        // parallels. Times are local times of an iteration of the timeline.
+        struct Entry
+        {
+            TweenTime start;        // local time 0 of the child
+            TweenTime activeStart;  // end of the child delay
+            TweenTime end;          // end of the child last repetition
+            TweenTime maxEnd;       // latest end in the subtree of this entry
+            TweenTime time;         // time the child was last updated to
+            BaseTween *child;
+            int order;              // position in the schedule, ties of the sort
+        };
+
+        std::vector<BaseTween *> children;
+        std::vector<Entry> entries;     // sorted on activeStart
+        Timeline *current;
+        Timeline *parent;
+        int mode;
+        bool isBuilt;
+        bool isPooled;
+        TweenTime childrenTime;         // time the schedule was last updated to
+
+        static TimelinePool &pool;
+
+        void setup(int mode);
+        bool isFlattened();
+        TweenTime schedule(std::vector<Entry> &schedule, TweenTime offset);
+        TweenTime buildTree(int first, int last);
+        template<typename Visitor> void visitEntries(int first, int last, TweenTime lo, TweenTime hi, bool isBackward, Visitor &visit);
+        void startChildren();
+        void updateChildren(TweenTime time);
+
+    protected:
+        virtual void reset();
+        virtual void forceStartValues();
+        virtual void forceEndValues();
+        virtual bool containsTarget(TweenHandle tweenHandle);
+        virtual void updateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta);
+        virtual void saveStateOverride(TweenSnapshotWriter &writer);
+        virtual bool restoreStateOverride(TweenSnapshotReader &reader);
+
+    public:
+        static size_t getPoolSize();
+        static void ensurePoolCapacity(int minCapacity);
+        static PoolStats getPoolStats();
+        static void trimPool(int maxIdle);
+        static void setPoolIdleLimit(int maxIdle);
+
+        static Timeline &createSequence();
+        static Timeline &createParallel();
+
+        Timeline();
+
+        virtual int getTweenCount();
+        virtual int getTimelineCount();
+
+        virtual Timeline &build();
+        virtual void free();
+
+        Timeline &push(Tween &tween);
+        Timeline &push(Timeline &timeline);
+        Timeline &pushPause(TweenTime time);
+        Timeline &beginSequence();
+        Timeline &beginParallel();
+        Timeline &end();
+        std::vector<BaseTween *> &getChildren();
+    };
+}
+
+#endif /* defined(__Timeline__) */
@@ -0,0 +1,29 @@
+//
+//  TimelinePool.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "TimelinePool.h"
+#include "Timeline.h"
+
+namespace TweenEngine
+{
+    void TimelinePoolCallback::onPool(Timeline *obj)
+    {
+        obj->reset();
+    }
+    
+    void TimelinePoolCallback::onUnPool(Timeline *obj)
+    {
+        obj->isPooled = false;
+        obj->reset();
+    }
+    
+    TimelinePool::TimelinePool() : Pool<TweenEngine::Timeline>(10, new TimelinePoolCallback())
+    {
+    }
+    
+    Timeline *TimelinePool::create() { return new Timeline(); }
+}
@@ -0,0 +1,32 @@
+//
+//  TimelinePool.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#ifndef __TimelinePool__
+#define __TimelinePool__
+
+#include "Pool.h"
+#include "Timeline.h"
+
+namespace TweenEngine
+{
+    class TimelinePoolCallback : public PoolCallback<Timeline>
+    {
+    public:
+        void onPool(Timeline *obj);
+        void onUnPool(Timeline *obj);
+    };
+    
+    class TimelinePool : public Pool<Timeline>
+    {
+    protected:
+        Timeline *create();
+    public:
+        TimelinePool();
+        
+    };
+}
+#endif /* defined(__TimelinePool__) */
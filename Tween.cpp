@@ -79,9 +79,14 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <utility>
 
 #include "Tween.h"
 #include "TweenPool.h"
+#include "TweenArena.h"
+#include "TweenSnapshot.h"
+#include "TweenStats.h"
 
 namespace TweenEngine
 {
@@ -89,14 +94,14 @@ namespace TweenEngine
     int Tween::waypointsLimit = 0;
     
 	/**
-	 * Changes the limit for combined attributes. Defaults to 3 to reduce
-	 * memory footprint.
+	 * Changes the limit for combined attributes. Defaults to 4 to reduce
+	 * memory footprint, must not exceed 255.
 	 */
 	void Tween::setCombinedAttributesLimit(int limit) { Tween::combinedAttrsLimit = limit; }
     
 	/**
 	 * Changes the limit of allowed waypoints for each tween. Defaults to 0 to
-	 * reduce memory footprint.
+	 * reduce memory footprint, must not exceed 255.
 	 */
 	void Tween::setWaypointsLimit(int limit) { Tween::waypointsLimit = limit; }
     
@@ -107,16 +112,44 @@ namespace TweenEngine
    
 	/**
 	 * Used for debug purpose. Gets the current number of objects that are
-	 * waiting in the Tween pool.
+	 * waiting in the Tween pool, not counting the ones cached by other
+	 * threads.
 	 */
 	size_t Tween::getPoolSize() { return pool.size(); }
     
 	/**
 	 * Increases the minimum capacity of the pool. Capacity defaults to 20.
+	 * <p/>
+	 *
+	 * The pool is thread-safe: tweens can be created on any thread, then
+	 * added to a manager through a {@link TweenCommandQueue}, and freed by
+	 * the update thread.
 	 */
 	void Tween::ensurePoolCapacity(int minCapacity) { pool.ensureCapacity(minCapacity); }
 
+	/**
+	 * Gets the usage counters of the Tween pool: peak usage and misses
+	 * tell how to size {@link #ensurePoolCapacity()}.
+	 */
+	PoolStats Tween::getPoolStats() { return pool.getStats(); }
+
+	/**
+	 * Deletes idle tweens of the pool, keeping at most the given number.
+	 */
+	void Tween::trimPool(int maxIdle) { pool.trim(maxIdle); }
+
+	/**
+	 * Keeps at most the given number of idle tweens in the pool, the ones
+	 * freed beyond are deleted. Unlimited if negative, the default.
+	 */
+	void Tween::setPoolIdleLimit(int maxIdle) { pool.setIdleLimit(maxIdle); }
+
     TweenPool &Tween::pool = *(new TweenPool());
+
+    Tween &Tween::obtain(TweenArena *arena)
+    {
+        return arena != NULL ? *(arena->getTween()) : *(pool.get());
+    }
     
 	// -------------------------------------------------------------------------
 	// Static -- factories
@@ -153,10 +186,10 @@ namespace TweenEngine
 	 * @param duration The duration of the interpolation, in milliseconds.
 	 * @return The generated Tween.
 	 */
-	Tween &Tween::to(TweenHandle tweenHandle, float duration, TweenAccessor accessor)
+	Tween &Tween::to(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor)
     {
-		Tween &tween = *(pool.get());
-		tween.setup(tweenHandle, duration, accessor);
+		Tween &tween = obtain(NULL);
+		tween.setup(tweenHandle, duration, std::move(accessor));
         tween.ease(TweenEquations::easeInOutQuad);
 		tween.path(TweenPaths::catmullRom);
 		return tween;
@@ -192,10 +225,10 @@ namespace TweenEngine
 	 * @param duration The duration of the interpolation, in milliseconds.
 	 * @return The generated Tween.
 	 */
-	Tween &Tween::from(TweenHandle tweenHandle, float duration, TweenAccessor accessor)
+	Tween &Tween::from(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor)
     {
-		Tween &tween = *(pool.get());
-		tween.setup(tweenHandle, duration, accessor);
+		Tween &tween = obtain(NULL);
+		tween.setup(tweenHandle, duration, std::move(accessor));
         tween.ease(TweenEquations::easeInOutQuad);
 		tween.path(TweenPaths::catmullRom);
 		tween.isFrom = true;
@@ -233,9 +266,8 @@ namespace TweenEngine
 	 */
 	Tween &Tween::set(TweenHandle tweenHandle, TweenAccessor accessor)
     {
-		Tween &tween = *(pool.get());
-		tween.setup(tweenHandle, 0, accessor);
-        tween.setup(tweenHandle, 0.0f, accessor);
+		Tween &tween = obtain(NULL);
+        tween.setup(tweenHandle, 0.0f, std::move(accessor));
         tween.ease(TweenEquations::easeInOutQuad);
 		return tween;
 	}
@@ -264,8 +296,9 @@ namespace TweenEngine
 	 */
 	Tween &Tween::call(TweenCallback &callback)
     {
-		Tween &tween = *(pool.get());
+		Tween &tween = obtain(NULL);
         tween.setup(0, 0.0f, nullptr);
+        tween.kind = KIND_CALL;
 		tween.setCallback(&callback);
 		tween.setCallbackTriggers(TweenCallback::START);
 		return tween;
@@ -282,8 +315,75 @@ namespace TweenEngine
 	 */
 	Tween &Tween::mark()
     {
-		Tween &tween = *(pool.get());
+		Tween &tween = obtain(NULL);
+        tween.setup(0, 0.0f, nullptr);
+        tween.kind = KIND_CALL;
+		return tween;
+	}
+
+	// -------------------------------------------------------------------------
+	// Static -- factories using the arena of a manager
+	// -------------------------------------------------------------------------
+
+	/**
+	 * Same as {@link #to()}, the tween and its values being allocated from
+	 * the given arena, see {@link TweenManager#getArena()}. Must be called on
+	 * the thread updating the manager.
+	 */
+	Tween &Tween::to(TweenArena &arena, TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor)
+    {
+		Tween &tween = obtain(&arena);
+		tween.setup(tweenHandle, duration, std::move(accessor));
+        tween.ease(TweenEquations::easeInOutQuad);
+		tween.path(TweenPaths::catmullRom);
+		return tween;
+	}
+
+	/**
+	 * Same as {@link #from()}, from the given arena.
+	 */
+	Tween &Tween::from(TweenArena &arena, TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor)
+    {
+		Tween &tween = obtain(&arena);
+		tween.setup(tweenHandle, duration, std::move(accessor));
+        tween.ease(TweenEquations::easeInOutQuad);
+		tween.path(TweenPaths::catmullRom);
+		tween.isFrom = true;
+		return tween;
+	}
+
+	/**
+	 * Same as {@link #set()}, from the given arena.
+	 */
+	Tween &Tween::set(TweenArena &arena, TweenHandle tweenHandle, TweenAccessor accessor)
+    {
+		Tween &tween = obtain(&arena);
+        tween.setup(tweenHandle, 0.0f, std::move(accessor));
+        tween.ease(TweenEquations::easeInOutQuad);
+		return tween;
+	}
+
+	/**
+	 * Same as {@link #call()}, from the given arena.
+	 */
+	Tween &Tween::call(TweenArena &arena, TweenCallback &callback)
+    {
+		Tween &tween = obtain(&arena);
+        tween.setup(0, 0.0f, nullptr);
+        tween.kind = KIND_CALL;
+		tween.setCallback(&callback);
+		tween.setCallbackTriggers(TweenCallback::START);
+		return tween;
+	}
+
+	/**
+	 * Same as {@link #mark()}, from the given arena.
+	 */
+	Tween &Tween::mark(TweenArena &arena)
+    {
+		Tween &tween = obtain(&arena);
         tween.setup(0, 0.0f, nullptr);
+        tween.kind = KIND_CALL;
 		return tween;
 	}
     
@@ -293,54 +393,92 @@ namespace TweenEngine
 
     Tween::Tween()
     {
-        startValues = new float[combinedAttrsLimit];
-        targetValues = new float[combinedAttrsLimit];
-        waypoints = new float[waypointsLimit*combinedAttrsLimit];
-        accessorBuffer = new float[combinedAttrsLimit];
-        accessorBufferSize = combinedAttrsLimit;
-        pathBuffer = new float[(2+waypointsLimit)*combinedAttrsLimit];
-        pathBufferSize = (2+waypointsLimit)*combinedAttrsLimit;
+        kind = KIND_TWEEN;
+        arena = NULL;
+        valuesCapacity = 0;
+        allocateValues();
+        accessor = NULL;
+		tweenHandle = 0;
+        isPooled = false;
+    }
+
+    Tween::Tween(TweenArena *arena)
+    {
+        kind = KIND_TWEEN;
+        this->arena = arena;
+        valuesCapacity = 0;
+        allocateValues();
         accessor = NULL;
 		tweenHandle = 0;
+        isPooled = false;
     }
     
     Tween::~Tween()
     {
-        delete startValues;
-        delete targetValues;
-        delete waypoints;
-        delete accessorBuffer;
-        delete pathBuffer;
+        if (arena == NULL) delete[] values;
+    }
+    
+    /**
+     * Lays out the values block for the current limits. The start values,
+     * target values, accessor buffer, waypoints and path buffer share a
+     * single allocation, so that the values of a tween are contiguous. The
+     * block is only reallocated when it grows, so that changing the limits
+     * back and forth doesn't allocate at every reuse of the pooled tweens.
+     * In an arena, the previous block is only given back by the arena reset.
+     */
+    void Tween::allocateValues()
+    {
+        assert(combinedAttrsLimit <= UINT8_MAX && waypointsLimit <= UINT8_MAX);
+        
+        int valuesCnt = (3+waypointsLimit)*combinedAttrsLimit + 2+waypointsLimit;
+        if (valuesCnt > valuesCapacity)
+        {
+            if (arena != NULL)
+            {
+                values = (float *)arena->allocate(valuesCnt*sizeof(float), sizeof(float));
+            }
+            else
+            {
+                delete[] values;
+                values = new float[valuesCnt];
+            }
+            valuesCapacity = valuesCnt;
+        }
+        valuesStride = (uint8_t)combinedAttrsLimit;
+        valuesWaypointsLimit = waypointsLimit;
+        
+        startValues = values;
+        targetValues = values + combinedAttrsLimit;
+        accessorBuffer = values + 2*combinedAttrsLimit;
+        waypoints = values + 3*combinedAttrsLimit;
+        pathBuffer = waypoints + waypointsLimit*combinedAttrsLimit;
     }
 
     void Tween::reset()
     {
         BaseTween::reset();
         
+        kind = KIND_TWEEN;
         equation = NULL;
         pathAlgorithm = NULL;
-        isFrom = isRelative = false;
+        isFrom = false;
 		combinedAttrsCnt = waypointsCnt = 0;
         
-		if (accessorBufferSize != combinedAttrsLimit) {
-			accessorBuffer = new float[combinedAttrsLimit];
-		}
-        
-		if (pathBufferSize != (2+waypointsLimit)*combinedAttrsLimit) {
-			pathBuffer = new float[(2+waypointsLimit)*combinedAttrsLimit];
+		if (valuesStride != combinedAttrsLimit || valuesWaypointsLimit != waypointsLimit) {
+			allocateValues();
 		}
 
         accessor = NULL;
 		tweenHandle = 0;
     }
     
-    void Tween::setup(TweenHandle tweenHandle, float duration, TweenAccessor accessor)
+    void Tween::setup(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor)
     {
         assert(duration >= 0);
         
 		this->tweenHandle = tweenHandle;
 		this->duration = duration;
-		this->accessor = accessor;
+		this->accessor = std::move(accessor);
 	}
    
     // -------------------------------------------------------------------------
@@ -465,7 +603,7 @@ namespace TweenEngine
 	 */
 	Tween &Tween::targetRelative(float targetValue)
     {
-		isRelative = true;
+		setRelative(true);
 		targetValues[0] = isInitialized() ? targetValue + startValues[0] : targetValue;
 		return *this;
 	}
@@ -485,7 +623,7 @@ namespace TweenEngine
 	 */
 	Tween &Tween::targetRelative(float targetValue1, float targetValue2)
     {
-		isRelative = true;
+		setRelative(true);
 		targetValues[0] = isInitialized() ? targetValue1 + startValues[0] : targetValue1;
 		targetValues[1] = isInitialized() ? targetValue2 + startValues[1] : targetValue2;
 		return *this;
@@ -507,7 +645,7 @@ namespace TweenEngine
 	 */
 	Tween &Tween::targetRelative(float targetValue1, float targetValue2, float targetValue3)
     {
-		isRelative = true;
+		setRelative(true);
 		targetValues[0] = isInitialized() ? targetValue1 + startValues[0] : targetValue1;
 		targetValues[1] = isInitialized() ? targetValue2 + startValues[1] : targetValue2;
 		targetValues[2] = isInitialized() ? targetValue3 + startValues[2] : targetValue3;
@@ -534,7 +672,7 @@ namespace TweenEngine
                 this->targetValues[i] = isInitialized() ? targetValues[i] + startValues[i] : targetValues[i];
         }
         
-		isRelative = true;
+		setRelative(true);
 		return *this;
 	}
 
@@ -652,6 +790,38 @@ namespace TweenEngine
 		return *this;
 	}
 
+	/**
+	 * Changes the target values of a tween, even while it is running. If an
+	 * iteration is playing, it restarts from the current values of the target
+	 * and heads to the new ones, for its full duration. Otherwise, only the
+	 * target values are replaced. The values are absolute.
+	 *
+	 * @param targetValues The new target values of the interpolation.
+	 * @return The current tween, for chaining instructions.
+	 */
+	Tween &Tween::retarget(const float *targetValues, int len)
+    {
+		if (len > combinedAttrsLimit) return *this;
+        
+		if (!isIterationStep() || accessor == NULL)
+        {
+			setRelative(false);
+			for (int i=0; i<len; i++) this->targetValues[i] = targetValues[i];
+			return *this;
+		}
+        
+		// A reverse iteration heads to the start values
+		bool isReverseStep = isReverse(getStep());
+		float *fromValues = isReverseStep ? this->targetValues : startValues;
+		float *toValues = isReverseStep ? startValues : this->targetValues;
+        
+		accessor(ACCESSOR_READ, fromValues);
+		TWEEN_STATS_COUNT(readCnt, 1);
+		for (int i=0; i<len; i++) toValues[i] = targetValues[i];
+		restartIteration();
+		return *this;
+	}
+
     // -------------------------------------------------------------------------
 	// Getters
 	// -------------------------------------------------------------------------
@@ -687,23 +857,33 @@ namespace TweenEngine
     {
         if (accessor != NULL)
         {
-            combinedAttrsCnt = accessor(ACCESSOR_READ, accessorBuffer);
+            int cnt = accessor(ACCESSOR_READ, accessorBuffer);
+            TWEEN_STATS_COUNT(readCnt, 1);
+            assert(cnt <= combinedAttrsLimit);
+            combinedAttrsCnt = (uint8_t)cnt;
         }
-        assert(combinedAttrsCnt <= combinedAttrsLimit);
 		return *this;
 	}
     
-	void Tween::free() { pool.free(this); }
+	void Tween::free()
+    {
+        // Guards against double frees, which would hand out the same object twice
+        if (isPooled) return;
+        isPooled = true;
+        if (arena != NULL) arena->freeTween(this);
+        else pool.free(this);
+    }
     
 	void Tween::initializeOverride()
     {
         accessor(ACCESSOR_READ, startValues);
+        TWEEN_STATS_COUNT(readCnt, 1);
         
 		for (int i=0; i<combinedAttrsCnt; i++) {
-			targetValues[i] += isRelative ? startValues[i] : 0;
+			targetValues[i] += isRelative() ? startValues[i] : 0;
             
 			for (int ii=0; ii<waypointsCnt; ii++) {
-				waypoints[ii*combinedAttrsCnt+i] += isRelative ? startValues[i] : 0;
+				waypoints[ii*combinedAttrsCnt+i] += isRelative() ? startValues[i] : 0;
 			}
             
 			if (isFrom) {
@@ -714,47 +894,93 @@ namespace TweenEngine
 		}
 	}
     
-	void Tween::updateOverride(int step, int lastStep, bool isIterationStep, float delta)
+    // The start and target values are saved as one copy of the start of
+    // the values block, whatever the number of combined attributes, so that
+    // every record of the same limits has the same size. The start values
+    // may not be read yet, and relative targets not be offset yet. The
+    // equation, counts and relative flag come with the hot block.
+
+    void Tween::saveStateOverride(TweenSnapshotWriter &writer)
+    {
+        writer.write(values, 2*valuesStride*sizeof(float));
+        if (waypointsCnt == 0) return;
+        writer.write(pathAlgorithm);
+        writer.write(waypoints, waypointsCnt*combinedAttrsCnt*sizeof(float));
+    }
+
+    bool Tween::restoreStateOverride(TweenSnapshotReader &reader)
+    {
+        if (combinedAttrsCnt > valuesStride || waypointsCnt > valuesWaypointsLimit) return reader.fail();
+        reader.read(values, 2*valuesStride*sizeof(float));
+        if (waypointsCnt == 0) return reader.isValid();
+        reader.read(pathAlgorithm);
+        reader.read(waypoints, waypointsCnt*combinedAttrsCnt*sizeof(float));
+        return reader.isValid();
+    }
+    
+	void Tween::updateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta)
     {
 		if (equation == NULL) return;
         
+		// Values are read through the hot block
+		float *startValues = values;
+		float *targetValues = values + valuesStride;
+		float *accessorBuffer = values + 2*valuesStride;
+        
 		// Case iteration end has been reached
         
 		if (!isIterationStep && step > lastStep)
         {
             accessor(ACCESSOR_WRITE, isReverse(lastStep) ? startValues : targetValues);
+            TWEEN_STATS_COUNT(writeCnt, 1);
 			return;
 		}
         
 		if (!isIterationStep && step < lastStep)
         {
             accessor(ACCESSOR_WRITE, isReverse(lastStep) ? targetValues : startValues);
+            TWEEN_STATS_COUNT(writeCnt, 1);
 			return;
 		}
         
 		// Validation
         
 		assert(isIterationStep);
+        
+		if (!computeValues(step, delta)) return;
+		accessor(ACCESSOR_WRITE, accessorBuffer);
+		TWEEN_STATS_COUNT(writeCnt, 1);
+	}
+    
+	/**
+	 * Computes the values of the current iteration into the accessor buffer,
+	 * without calling the accessor. Returns false if there is nothing to
+	 * write.
+	 */
+	bool Tween::computeValues(int step, TweenTime delta)
+    {
+		if (equation == NULL) return false;
+        
+		float *startValues = values;
+		float *targetValues = values + valuesStride;
+		float *accessorBuffer = values + 2*valuesStride;
+        
 		assert(getCurrentTime() >= 0);
 		assert(getCurrentTime() <= duration);
         
 		// Case duration equals zero
         
-		if (duration < 0.00000000001f && delta > -0.00000000001f)
+		if (duration < 0.00000000001f)
         {
-            accessor(ACCESSOR_WRITE, isReverse(step) ? targetValues : startValues);
-			return;
-		}
-        
-		if (duration < 0.00000000001f && delta < 0.00000000001f) {
-			accessor(ACCESSOR_WRITE, isReverse(step) ? startValues : targetValues);
-			return;
+			float *src = (delta > -0.00000000001f) == isReverse(step) ? targetValues : startValues;
+			for (int i=0; i<combinedAttrsCnt; i++) accessorBuffer[i] = src[i];
+			return true;
 		}
         
 		// Normal behavior
         
-		float time = isReverse(step) ? duration - getCurrentTime() : getCurrentTime();
-		float t = equation->compute(time/duration);
+		TweenTime time = isReverse(step) ? duration - getCurrentTime() : getCurrentTime();
+		float t = equation->compute((float)(time/duration));
         
 		if (waypointsCnt == 0 || pathAlgorithm == NULL)
         {
@@ -779,17 +1005,28 @@ namespace TweenEngine
 			}
 		}
         
-		accessor(ACCESSOR_WRITE, accessorBuffer);
+		return true;
+	}
+    
+	/**
+	 * Writes the values computed by computeValues() to the target.
+	 */
+	void Tween::writeValues()
+    {
+		accessor(ACCESSOR_WRITE, values + 2*valuesStride);
+		TWEEN_STATS_COUNT(writeCnt, 1);
 	}
 
 	void Tween::forceStartValues()
     {
-		accessor(ACCESSOR_WRITE, startValues);
+		accessor(ACCESSOR_WRITE, values);
+		TWEEN_STATS_COUNT(writeCnt, 1);
 	}
     
 	void Tween::forceEndValues()
     {
-		accessor(ACCESSOR_WRITE, targetValues);
+		accessor(ACCESSOR_WRITE, values + valuesStride);
+		TWEEN_STATS_COUNT(writeCnt, 1);
 	}
 
     bool Tween::containsTarget(TweenHandle tweenHandle)
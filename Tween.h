@@ -22,41 +22,48 @@ namespace TweenEngine
 {
     class TweenPool;
     class TweenPoolCallback;
+    class TweenArena;
     
     class Tween : public BaseTween
     {
+        friend class BaseTween;
         friend class TweenPoolCallback;
+        friend class TweenArena;
         
     private:
         static int combinedAttrsLimit;
         static int waypointsLimit;
         
+        // Cold block -- the hot fields (equation, counts and the values
+        // block) live in BaseTween.
+        
         // Main
 		TweenAccessor accessor;
+		float *accessorBuffer;
 		TweenHandle tweenHandle;
-		TweenEquation *equation;
         TweenPath *pathAlgorithm;
 
         // General
         bool isFrom;
-        bool isRelative;
-        int combinedAttrsCnt;
-        int waypointsCnt;
+        bool isPooled;
+        TweenArena *arena;      // owner of the memory, or NULL for the pool
 
-        // Values
+        // Values (inside the values block)
         float* startValues;
         float* targetValues;
         float* waypoints;
-        
-        // Buffers
-        float *accessorBuffer;
-        int accessorBufferSize;
         float *pathBuffer;
-        int pathBufferSize;
+        int valuesWaypointsLimit;
+        int valuesCapacity;
 
         static TweenPool &pool;
 
-        void setup(TweenHandle tweenHandle, float duration, TweenAccessor accessor);
+        static Tween &obtain(TweenArena *arena);
+        Tween(TweenArena *arena);
+        void allocateValues();
+        bool computeValues(int step, TweenTime delta);
+        void writeValues();
+        void setup(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor);
         
     protected:
         virtual void reset();
@@ -64,7 +71,9 @@ namespace TweenEngine
         virtual void forceEndValues();
         virtual bool containsTarget(TweenHandle tweenHandle);
         virtual void initializeOverride();
-        virtual void updateOverride(int step, int lastStep, bool isIterationStep, float delta);
+        virtual void updateOverride(int step, int lastStep, bool isIterationStep, TweenTime delta);
+        virtual void saveStateOverride(TweenSnapshotWriter &writer);
+        virtual bool restoreStateOverride(TweenSnapshotReader &reader);
         
     public:
         static const int ACCESSOR_READ = 0;
@@ -76,12 +85,20 @@ namespace TweenEngine
         
         static size_t getPoolSize();
         static void ensurePoolCapacity(int minCapacity);
+        static PoolStats getPoolStats();
+        static void trimPool(int maxIdle);
+        static void setPoolIdleLimit(int maxIdle);
       
-        static Tween &to(TweenHandle tweenHandle, float duration, TweenAccessor accessor);
-        static Tween &from(TweenHandle tweenHandle, float duration, TweenAccessor accessor);
+        static Tween &to(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor);
+        static Tween &from(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor);
         static Tween &set(TweenHandle tweenHandle, TweenAccessor accessor);
         static Tween &call(TweenCallback &callback);
         static Tween &mark();
+        static Tween &to(TweenArena &arena, TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor);
+        static Tween &from(TweenArena &arena, TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor);
+        static Tween &set(TweenArena &arena, TweenHandle tweenHandle, TweenAccessor accessor);
+        static Tween &call(TweenArena &arena, TweenCallback &callback);
+        static Tween &mark(TweenArena &arena);
         
         Tween();
         ~Tween();
@@ -106,6 +123,7 @@ namespace TweenEngine
         Tween &waypoint(float targetValue1, float targetValue2, float targetValue3);
         Tween &waypoint(float *targetValues, int len);
         Tween &path(TweenPath &path);
+        Tween &retarget(const float *targetValues, int len);
         TweenEquation *getEasing();
 		TweenHandle getHandle();
         float *getTargetValues();
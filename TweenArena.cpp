@@ -0,0 +1,128 @@
+//
+//  TweenArena.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include <stdint.h>
+#include <new>
+
+#include "TweenArena.h"
+#include "Tween.h"
+
+namespace TweenEngine
+{
+    /**
+     * Creates an empty arena, taking memory by chunks of the given size.
+     */
+    TweenArena::TweenArena(size_t chunkSize) : chunks(), freeTweens()
+    {
+        this->chunkSize = chunkSize;
+        currentChunk = 0;
+        currentOffset = 0;
+    }
+
+    TweenArena::~TweenArena()
+    {
+        reset();
+        for (int i=0, n=(int)chunks.size(); i<n; i++) delete[] chunks[i].memory;
+    }
+
+    /**
+     * Takes memory from the current chunk, or from the next one large enough,
+     * allocating it if needed. The memory is only given back by reset().
+     */
+    void *TweenArena::allocate(size_t size, size_t alignment)
+    {
+        while (currentChunk < (int)chunks.size())
+        {
+            Chunk &chunk = chunks[currentChunk];
+            uintptr_t base = (uintptr_t)chunk.memory;
+            uintptr_t ptr = (base + currentOffset + alignment-1) & ~(uintptr_t)(alignment-1);
+            if (ptr + size <= base + chunk.size)
+            {
+                currentOffset = ptr + size - base;
+                return (void *)ptr;
+            }
+            currentChunk++;
+            currentOffset = 0;
+        }
+
+        Chunk chunk;
+        chunk.size = size + alignment > chunkSize ? size + alignment : chunkSize;
+        chunk.memory = new char[chunk.size];
+        chunks.push_back(chunk);
+        currentChunk = (int)chunks.size() - 1;
+        currentOffset = 0;
+        return allocate(size, alignment);
+    }
+
+    /**
+     * Gets a tween freed to the arena, or a new one.
+     */
+    Tween *TweenArena::getTween()
+    {
+        Tween *tween;
+        if (!freeTweens.empty())
+        {
+            tween = freeTweens.back();
+            freeTweens.pop_back();
+        }
+        else
+        {
+            // Tween::operator new is the aligned heap one, hence the global placement new
+            void *memory = allocate(sizeof(Tween), BaseTween::CACHE_LINE_SIZE);
+            tween = ::new (memory) Tween(this);
+        }
+
+        tween->isPooled = false;
+        tween->reset();
+        return tween;
+    }
+
+    void TweenArena::freeTween(Tween *tween)
+    {
+        tween->reset();
+        freeTweens.push_back(tween);
+    }
+
+    /**
+     * Ends a tween of the arena still in use, before a reset. Returns false
+     * if the tween is not from this arena.
+     */
+    bool TweenArena::drop(Tween *tween)
+    {
+        if (tween->arena != this) return false;
+        tween->~Tween();
+        return true;
+    }
+
+    /**
+     * Destroys the tweens freed to the arena, then gives back the memory of
+     * every tween at once. Tweens in use must have been freed or dropped
+     * before.
+     */
+    void TweenArena::reset()
+    {
+        for (int i=0, n=(int)freeTweens.size(); i<n; i++) freeTweens[i]->~Tween();
+        freeTweens.clear();
+        currentChunk = 0;
+        currentOffset = 0;
+    }
+
+    /**
+     * Gets the number of tweens waiting in the arena.
+     */
+    size_t TweenArena::size() { return freeTweens.size(); }
+
+    /**
+     * Gets the memory taken by the chunks of the arena.
+     */
+    size_t TweenArena::getMemorySize()
+    {
+        size_t total = 0;
+        for (int i=0, n=(int)chunks.size(); i<n; i++) total += chunks[i].size;
+        return total;
+    }
+}
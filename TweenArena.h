@@ -0,0 +1,76 @@
+//
+//  TweenArena.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A region of memory owned by a {@link TweenManager}, from which tweens and
+ * their values are allocated instead of the global Tween pool. Memory is
+ * taken from large chunks, so that the tweens of a manager stay next to each
+ * other and apart from the ones of other managers, each tween followed by
+ * its values. Freed tweens are reused by the arena only.
+ * <p/>
+ *
+ * The arena is not thread-safe: its tweens must be created, added and freed
+ * on the thread updating the manager. Tweens created on other threads, for
+ * instance for a {@link TweenCommandQueue}, come from the global pool.
+ * <p/>
+ *
+ * {@link TweenManager#clear()} still visits every tween, to release its id
+ * and run its destructor (which releases the captures of its accessor),
+ * but the memory is given back at once instead of tween by tween. Chunks
+ * are kept for the next tweens and only freed with the manager.
+ *
+ * @see TweenManager
+ * @see Tween
+ */
+
+#ifndef __TweenArena__
+#define __TweenArena__
+
+#include <cstddef>
+#include <vector>
+
+namespace TweenEngine
+{
+    class Tween;
+
+    class TweenArena
+    {
+    public:
+        static const size_t DEFAULT_CHUNK_SIZE = 64*1024;
+
+    private:
+        struct Chunk
+        {
+            char *memory;
+            size_t size;
+        };
+
+        std::vector<Chunk> chunks;
+        std::vector<Tween *> freeTweens;
+        size_t chunkSize;
+        int currentChunk;
+        size_t currentOffset;
+
+        TweenArena(const TweenArena &);
+        TweenArena &operator=(const TweenArena &);
+
+    public:
+        TweenArena(size_t chunkSize);
+        ~TweenArena();
+
+        void *allocate(size_t size, size_t alignment);
+        Tween *getTween();
+        void freeTween(Tween *tween);
+        bool drop(Tween *tween);
+        void reset();
+
+        size_t size();
+        size_t getMemorySize();
+    };
+}
+
+#endif /* defined(__TweenArena__) */
@@ -59,6 +59,15 @@ namespace TweenEngine
         
         virtual ~TweenCallback() {}
         virtual void onEvent(int type, BaseTween *source) = 0;
+        
+        /**
+         * Called instead of onEvent() when a big delta time made the source
+         * skip several iterations at once and its catch-up policy is
+         * BaseTween::CATCHUP_COALESCE. Fires a single onEvent() by default.
+         *
+         * @param count The number of occurrences of the event.
+         */
+        virtual void onEvents(int type, BaseTween *source, int count) { onEvent(type, source); }
     };
     
 }
@@ -0,0 +1,357 @@
+//
+//  TweenCommandQueue.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include <utility>
+
+#include "TweenCommandQueue.h"
+#include "TweenManager.h"
+
+namespace TweenEngine
+{
+    // -------------------------------------------------------------------------
+	// TweenSpawn
+	// -------------------------------------------------------------------------
+
+    /**
+     * Describes a Tween::to() interpolation.
+     */
+    TweenSpawn TweenSpawn::to(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor)
+    {
+        TweenSpawn spawn;
+        spawn.tweenHandle = tweenHandle;
+        spawn.duration = duration;
+        spawn.accessor = std::move(accessor);
+        return spawn;
+    }
+
+    /**
+     * Describes a Tween::from() interpolation.
+     */
+    TweenSpawn TweenSpawn::from(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor)
+    {
+        TweenSpawn spawn = to(tweenHandle, duration, std::move(accessor));
+        spawn.isFrom = true;
+        return spawn;
+    }
+
+    /**
+     * Describes a Tween::set() instantaneous interpolation.
+     */
+    TweenSpawn TweenSpawn::set(TweenHandle tweenHandle, TweenAccessor accessor)
+    {
+        return to(tweenHandle, 0, std::move(accessor));
+    }
+
+    /**
+     * Describes a Tween::call() timer.
+     */
+    TweenSpawn TweenSpawn::call(TweenCallback &callback)
+    {
+        TweenSpawn spawn;
+        spawn.isCall = true;
+        spawn.callback = &callback;
+        spawn.callbackTriggers = TweenCallback::START;
+        return spawn;
+    }
+
+    TweenSpawn::TweenSpawn()
+    {
+        tweenHandle = 0;
+        duration = 0;
+        accessor = nullptr;
+        callback = NULL;
+        callbackTriggers = TweenCallback::COMPLETE;
+        userData = NULL;
+        catchUpPolicy = BaseTween::CATCHUP_FIRE_ALL;
+        isCall = isFrom = isRelative = isYoyo = false;
+        equation = NULL;
+        pathAlgorithm = NULL;
+        delayStart = repeatDelay = 0;
+        repeatCnt = 0;
+        targetsCnt = waypointsCnt = waypointsLen = 0;
+    }
+
+    TweenSpawn &TweenSpawn::setTargets(const float *targetValues, int len, bool isRelative)
+    {
+        if (len <= TARGETS_LIMIT)
+        {
+            for (int i=0; i<len; i++) this->targetValues[i] = targetValues[i];
+            targetsCnt = len;
+            this->isRelative = isRelative;
+        }
+        return *this;
+    }
+
+    TweenSpawn &TweenSpawn::target(float targetValue) { return setTargets(&targetValue, 1, false); }
+
+    TweenSpawn &TweenSpawn::target(float targetValue1, float targetValue2)
+    {
+        float targetValues[] = {targetValue1, targetValue2};
+        return setTargets(targetValues, 2, false);
+    }
+
+    TweenSpawn &TweenSpawn::target(float targetValue1, float targetValue2, float targetValue3)
+    {
+        float targetValues[] = {targetValue1, targetValue2, targetValue3};
+        return setTargets(targetValues, 3, false);
+    }
+
+    TweenSpawn &TweenSpawn::target(const float *targetValues, int len) { return setTargets(targetValues, len, false); }
+
+    TweenSpawn &TweenSpawn::targetRelative(float targetValue) { return setTargets(&targetValue, 1, true); }
+
+    TweenSpawn &TweenSpawn::targetRelative(float targetValue1, float targetValue2)
+    {
+        float targetValues[] = {targetValue1, targetValue2};
+        return setTargets(targetValues, 2, true);
+    }
+
+    TweenSpawn &TweenSpawn::targetRelative(float targetValue1, float targetValue2, float targetValue3)
+    {
+        float targetValues[] = {targetValue1, targetValue2, targetValue3};
+        return setTargets(targetValues, 3, true);
+    }
+
+    TweenSpawn &TweenSpawn::targetRelative(const float *targetValues, int len) { return setTargets(targetValues, len, true); }
+
+    TweenSpawn &TweenSpawn::waypoint(float targetValue) { return waypoint(&targetValue, 1); }
+
+    TweenSpawn &TweenSpawn::waypoint(float targetValue1, float targetValue2)
+    {
+        float targetValues[] = {targetValue1, targetValue2};
+        return waypoint(targetValues, 2);
+    }
+
+    TweenSpawn &TweenSpawn::waypoint(float targetValue1, float targetValue2, float targetValue3)
+    {
+        float targetValues[] = {targetValue1, targetValue2, targetValue3};
+        return waypoint(targetValues, 3);
+    }
+
+    /**
+     * Adds a waypoint. Every waypoint of a spawn must have the same number of
+     * values, the extra ones are ignored.
+     */
+    TweenSpawn &TweenSpawn::waypoint(const float *targetValues, int len)
+    {
+        if (waypointsCnt > 0 && len != waypointsLen) return *this;
+        if ((waypointsCnt+1)*len > WAYPOINTS_VALUES_LIMIT) return *this;
+
+        for (int i=0; i<len; i++) waypoints[waypointsCnt*len+i] = targetValues[i];
+        waypointsLen = len;
+        waypointsCnt += 1;
+        return *this;
+    }
+
+    TweenSpawn &TweenSpawn::ease(TweenEquation &easeEquation) { equation = &easeEquation; return *this; }
+    TweenSpawn &TweenSpawn::path(TweenPath &path) { pathAlgorithm = &path; return *this; }
+    TweenSpawn &TweenSpawn::delay(TweenTime delay) { delayStart += delay; return *this; }
+
+    TweenSpawn &TweenSpawn::repeat(int count, TweenTime delay)
+    {
+        repeatCnt = count;
+        repeatDelay = delay;
+        isYoyo = false;
+        return *this;
+    }
+
+    TweenSpawn &TweenSpawn::repeatYoyo(int count, TweenTime delay)
+    {
+        repeatCnt = count;
+        repeatDelay = delay;
+        isYoyo = true;
+        return *this;
+    }
+
+    TweenSpawn &TweenSpawn::setCallback(TweenCallback *callback) { this->callback = callback; return *this; }
+    TweenSpawn &TweenSpawn::setCallbackTriggers(int flags) { callbackTriggers = flags; return *this; }
+    TweenSpawn &TweenSpawn::setCatchUpPolicy(int policy) { catchUpPolicy = policy; return *this; }
+    TweenSpawn &TweenSpawn::setUserData(void *data) { userData = data; return *this; }
+
+    /**
+     * Creates the described tween, the accessor being moved to it. Must be
+     * called on the update thread.
+     */
+    Tween &TweenSpawn::build()
+    {
+        Tween &tween = isCall ? Tween::call(*callback)
+            : isFrom ? Tween::from(tweenHandle, duration, std::move(accessor))
+            : Tween::to(tweenHandle, duration, std::move(accessor));
+
+        if (targetsCnt > 0)
+        {
+            if (isRelative) tween.targetRelative(targetValues, targetsCnt);
+            else tween.target(targetValues, targetsCnt);
+        }
+        for (int i=0; i<waypointsCnt; i++) tween.waypoint(waypoints + i*waypointsLen, waypointsLen);
+        if (equation != NULL) tween.ease(*equation);
+        if (pathAlgorithm != NULL) tween.path(*pathAlgorithm);
+
+        if (isYoyo) tween.repeatYoyo(repeatCnt, repeatDelay);
+        else tween.repeat(repeatCnt, repeatDelay);
+        tween.delay(delayStart);
+        tween.setCallback(callback);
+        tween.setCallbackTriggers(callbackTriggers);
+        tween.setCatchUpPolicy(catchUpPolicy);
+        tween.setUserData(userData);
+        return tween;
+    }
+
+    // -------------------------------------------------------------------------
+	// TweenCommandQueue
+	// -------------------------------------------------------------------------
+
+    /**
+     * Creates a queue able to hold the given number of commands, rounded up to
+     * the next power of two.
+     */
+    TweenCommandQueue::TweenCommandQueue(int capacity) : commands(capacity)
+    {
+    }
+
+    bool TweenCommandQueue::post(int type, TweenHandle tweenHandle, TweenId id)
+    {
+        Command command;
+        command.type = type;
+        command.tweenHandle = tweenHandle;
+        command.id = id;
+        command.object = NULL;
+        return commands.push(std::move(command));
+    }
+
+    /**
+     * Spawns a tween and adds it to the manager, see {@link TweenSpawn}.
+     */
+    bool TweenCommandQueue::spawn(const TweenSpawn &spawn) { return this->spawn(spawn, 0); }
+
+    /**
+     * Spawns a tween and adds it to the manager under an id obtained from
+     * {@link TweenManager#reserveId()}, so that the posting thread can refer
+     * to it right away.
+     */
+    bool TweenCommandQueue::spawn(const TweenSpawn &spawn, TweenId id)
+    {
+        Command command;
+        command.type = SPAWN;
+        command.tweenHandle = spawn.tweenHandle;
+        command.id = id;
+        command.object = NULL;
+        command.spawn = spawn;
+        return commands.push(std::move(command));
+    }
+
+    /**
+     * Adds a tween or timeline built on the posting thread to the manager,
+     * see {@link TweenManager#add()}. It must not be touched by the posting
+     * thread anymore.
+     */
+    bool TweenCommandQueue::add(BaseTween &object) { return add(object, 0); }
+
+    /**
+     * Same as add(), under an id obtained from {@link TweenManager#reserveId()}.
+     */
+    bool TweenCommandQueue::add(BaseTween &object, TweenId id)
+    {
+        Command command;
+        command.type = ADD;
+        command.tweenHandle = 0;
+        command.id = id;
+        command.object = &object;
+        return commands.push(std::move(command));
+    }
+
+    /**
+     * Posts a {@link TweenManager#kill()} of a single tween.
+     */
+    bool TweenCommandQueue::kill(TweenId id) { return post(KILL_TWEEN, 0, id); }
+
+    /**
+     * Posts a {@link TweenManager#pause()} of a single tween.
+     */
+    bool TweenCommandQueue::pause(TweenId id) { return post(PAUSE_TWEEN, 0, id); }
+
+    /**
+     * Posts a {@link TweenManager#resume()} of a single tween.
+     */
+    bool TweenCommandQueue::resume(TweenId id) { return post(RESUME_TWEEN, 0, id); }
+
+    /**
+     * Posts a {@link TweenManager#retarget()}. At most
+     * TweenSpawn::TARGETS_LIMIT values are accepted.
+     */
+    bool TweenCommandQueue::retarget(TweenId id, const float *targetValues, int len)
+    {
+        if (len > TweenSpawn::TARGETS_LIMIT) return false;
+        
+        Command command;
+        command.type = RETARGET_TWEEN;
+        command.tweenHandle = 0;
+        command.id = id;
+        command.object = NULL;
+        command.spawn.target(targetValues, len);
+        return commands.push(std::move(command));
+    }
+
+    /**
+     * Posts a {@link TweenManager#killTarget()}.
+     */
+    bool TweenCommandQueue::killTarget(TweenHandle tweenHandle) { return post(KILL_TARGET, tweenHandle, 0); }
+
+    /**
+     * Posts a {@link TweenManager#killAll()}.
+     */
+    bool TweenCommandQueue::killAll() { return post(KILL_ALL, 0, 0); }
+
+    /**
+     * Posts a {@link TweenManager#pauseTarget()}.
+     */
+    bool TweenCommandQueue::pauseTarget(TweenHandle tweenHandle) { return post(PAUSE_TARGET, tweenHandle, 0); }
+
+    /**
+     * Posts a {@link TweenManager#resumeTarget()}.
+     */
+    bool TweenCommandQueue::resumeTarget(TweenHandle tweenHandle) { return post(RESUME_TARGET, tweenHandle, 0); }
+
+    /**
+     * Posts a {@link TweenManager#pause()}.
+     */
+    bool TweenCommandQueue::pause() { return post(PAUSE, 0, 0); }
+
+    /**
+     * Posts a {@link TweenManager#resume()}.
+     */
+    bool TweenCommandQueue::resume() { return post(RESUME, 0, 0); }
+
+    int TweenCommandQueue::getCapacity() { return commands.capacity(); }
+
+    /**
+     * Executes every queued command, in posting order.
+     */
+    void TweenCommandQueue::drain(TweenManager &manager)
+    {
+        Command command;
+
+        while (commands.pop(command))
+        {
+            switch (command.type)
+            {
+                case SPAWN: manager.add(command.spawn.build(), command.id); break;
+                case KILL_TARGET: manager.killTarget(command.tweenHandle); break;
+                case KILL_ALL: manager.killAll(); break;
+                case PAUSE_TARGET: manager.pauseTarget(command.tweenHandle); break;
+                case RESUME_TARGET: manager.resumeTarget(command.tweenHandle); break;
+                case PAUSE: manager.pause(); break;
+                case RESUME: manager.resume(); break;
+                case ADD: manager.add(*command.object, command.id); break;
+                case KILL_TWEEN: manager.kill(command.id); break;
+                case PAUSE_TWEEN: manager.pause(command.id); break;
+                case RESUME_TWEEN: manager.resume(command.id); break;
+                case RETARGET_TWEEN: manager.retarget(command.id, command.spawn.targetValues, command.spawn.targetsCnt); break;
+            }
+        }
+    }
+}
@@ -0,0 +1,175 @@
+//
+//  TweenCommandQueue.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A preallocated lock-free queue of commands for a {@link TweenManager},
+ * letting other threads spawn, kill or pause tweens while the manager is
+ * updated. Any number of threads may post at the same time. The manager
+ * drains the queue at the start of every update, see
+ * {@link TweenManager#setCommandQueue()}, so the tweens are only created and
+ * touched on the update thread, without any lock.
+ * <p/>
+ *
+ * A spawn is described by a {@link TweenSpawn}, which mirrors the builder
+ * API of Tween:
+ *
+ * <pre> {@code
+ * queue.spawn(TweenSpawn::to(myHandle, 0.5f, myAccessor)
+ *     .target(200, 300)
+ *     .ease(TweenEquations::easeInOutQuad)
+ *     .delay(1.0f));
+ * }</pre>
+ *
+ * To refer to a spawned tween before it exists, reserve its id with
+ * {@link TweenManager#reserveId()} and pass it to spawn().
+ * <p/>
+ *
+ * Since the Tween pool is thread-safe, a tween can also be built on the
+ * posting thread and handed over with add().
+ * <p/>
+ *
+ * Posting returns false when the queue is full, in which case nothing is
+ * recorded and the caller may retry later.
+ *
+ * @see TweenManager
+ */
+
+#ifndef __TweenCommandQueue__
+#define __TweenCommandQueue__
+
+#include "BaseTween.h"
+#include "RingBuffer.h"
+#include "Tween.h"
+
+namespace TweenEngine
+{
+    /**
+     * The builder parameters of a tween spawned through a command queue.
+     * Plain value, filled on the posting thread and turned into a real Tween
+     * on the update thread.
+     */
+    class TweenSpawn
+    {
+        friend class TweenCommandQueue;
+
+    public:
+        static const int TARGETS_LIMIT = 8;
+        static const int WAYPOINTS_VALUES_LIMIT = 32;
+
+    private:
+        TweenHandle tweenHandle;
+        TweenTime duration;
+        TweenAccessor accessor;
+        TweenCallback *callback;
+        int callbackTriggers;
+        void *userData;
+        int catchUpPolicy;
+        bool isCall;
+        bool isFrom;
+        bool isRelative;
+        bool isYoyo;
+        TweenEquation *equation;
+        TweenPath *pathAlgorithm;
+        TweenTime delayStart;
+        int repeatCnt;
+        TweenTime repeatDelay;
+
+        float targetValues[TARGETS_LIMIT];
+        float waypoints[WAYPOINTS_VALUES_LIMIT];
+        int targetsCnt;
+        int waypointsCnt;
+        int waypointsLen;
+
+        TweenSpawn &setTargets(const float *targetValues, int len, bool isRelative);
+        Tween &build();
+
+    public:
+        static TweenSpawn to(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor);
+        static TweenSpawn from(TweenHandle tweenHandle, TweenTime duration, TweenAccessor accessor);
+        static TweenSpawn set(TweenHandle tweenHandle, TweenAccessor accessor);
+        static TweenSpawn call(TweenCallback &callback);
+
+        TweenSpawn();
+
+        TweenSpawn &target(float targetValue);
+        TweenSpawn &target(float targetValue1, float targetValue2);
+        TweenSpawn &target(float targetValue1, float targetValue2, float targetValue3);
+        TweenSpawn &target(const float *targetValues, int len);
+        TweenSpawn &targetRelative(float targetValue);
+        TweenSpawn &targetRelative(float targetValue1, float targetValue2);
+        TweenSpawn &targetRelative(float targetValue1, float targetValue2, float targetValue3);
+        TweenSpawn &targetRelative(const float *targetValues, int len);
+        TweenSpawn &waypoint(float targetValue);
+        TweenSpawn &waypoint(float targetValue1, float targetValue2);
+        TweenSpawn &waypoint(float targetValue1, float targetValue2, float targetValue3);
+        TweenSpawn &waypoint(const float *targetValues, int len);
+        TweenSpawn &ease(TweenEquation &easeEquation);
+        TweenSpawn &path(TweenPath &path);
+        TweenSpawn &delay(TweenTime delay);
+        TweenSpawn &repeat(int count, TweenTime delay);
+        TweenSpawn &repeatYoyo(int count, TweenTime delay);
+        TweenSpawn &setCallback(TweenCallback *callback);
+        TweenSpawn &setCallbackTriggers(int flags);
+        TweenSpawn &setCatchUpPolicy(int policy);
+        TweenSpawn &setUserData(void *data);
+    };
+
+    class TweenCommandQueue
+    {
+        friend class TweenManager;
+
+    private:
+        static const int SPAWN = 0;
+        static const int KILL_TARGET = 1;
+        static const int KILL_ALL = 2;
+        static const int PAUSE_TARGET = 3;
+        static const int RESUME_TARGET = 4;
+        static const int PAUSE = 5;
+        static const int RESUME = 6;
+        static const int ADD = 7;
+        static const int KILL_TWEEN = 8;
+        static const int PAUSE_TWEEN = 9;
+        static const int RESUME_TWEEN = 10;
+        static const int RETARGET_TWEEN = 11;
+
+        struct Command
+        {
+            int type;
+            TweenHandle tweenHandle;
+            TweenId id;
+            BaseTween *object;
+            TweenSpawn spawn;
+        };
+
+        RingBuffer<Command> commands;
+
+        bool post(int type, TweenHandle tweenHandle, TweenId id);
+        void drain(TweenManager &manager);
+
+    public:
+        TweenCommandQueue(int capacity);
+
+        bool spawn(const TweenSpawn &spawn);
+        bool spawn(const TweenSpawn &spawn, TweenId id);
+        bool add(BaseTween &object);
+        bool add(BaseTween &object, TweenId id);
+        bool kill(TweenId id);
+        bool pause(TweenId id);
+        bool resume(TweenId id);
+        bool retarget(TweenId id, const float *targetValues, int len);
+        bool killTarget(TweenHandle tweenHandle);
+        bool killAll();
+        bool pauseTarget(TweenHandle tweenHandle);
+        bool resumeTarget(TweenHandle tweenHandle);
+        bool pause();
+        bool resume();
+
+        int getCapacity();
+    };
+}
+
+#endif /* defined(__TweenCommandQueue__) */
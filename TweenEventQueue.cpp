@@ -0,0 +1,70 @@
+//
+//  TweenEventQueue.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "TweenEventQueue.h"
+#include "TweenTracer.h"
+
+namespace TweenEngine
+{
+    /**
+     * Creates a queue able to hold the given number of events, rounded up to
+     * the next power of two. Nothing is allocated after construction.
+     */
+    TweenEventQueue::TweenEventQueue(int capacity) : events(capacity)
+    {
+        overflowCnt.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Records an event. Safe to call from several threads at once. Returns
+     * false, and counts an overflow, if the queue is full.
+     */
+    bool TweenEventQueue::push(const TweenEvent &event)
+    {
+        if (events.push(event)) return true;
+        overflowCnt.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * Takes the oldest event out of the queue. Returns false if the queue is
+     * empty. Safe to call from several threads at once.
+     */
+    bool TweenEventQueue::pop(TweenEvent &event) { return events.pop(event); }
+
+    /**
+     * Pops every queued event and calls its callback, in recording order.
+     * Returns the number of dispatched events. Long callbacks are traced
+     * when dispatched by the update of a manager with a tracer.
+     */
+    int TweenEventQueue::dispatch()
+    {
+        TweenEvent event;
+        int cnt = 0;
+        TweenTracer *tracer = TweenTracer::getCurrent();
+
+        while (pop(event))
+        {
+            TweenId id = tracer != NULL ? event.source->getId() : 0;
+            int64_t start = tracer != NULL ? TweenTracer::now() : 0;
+            if (event.count > 1) event.callback->onEvents(event.type, event.source, event.count);
+            else event.callback->onEvent(event.type, event.source);
+            if (tracer != NULL) tracer->traceCallback(event.type, id, start);
+            cnt++;
+        }
+
+        return cnt;
+    }
+
+    int TweenEventQueue::getCapacity() { return events.capacity(); }
+
+    /**
+     * Gets the number of events that found the queue full since its creation.
+     * These were fired synchronously instead.
+     */
+    int TweenEventQueue::getOverflowCount() { return overflowCnt.load(std::memory_order_relaxed); }
+}
@@ -0,0 +1,69 @@
+//
+//  TweenEventQueue.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A preallocated ring buffer of callback events. When a manager is given an
+ * event queue, see {@link TweenManager#setEventQueue()}, its tweens record
+ * their callback events here instead of calling their callbacks from the
+ * middle of the update loop. The events are then dispatched in one pass at
+ * the end of the update, or drained by the caller with pop(), possibly from
+ * another thread.
+ * <p/>
+ *
+ * Any number of threads may push at the same time (the parallel update does)
+ * while others pop, without locks. When the queue is full, the event is
+ * fired synchronously instead, ahead of the queued ones, so no event is ever
+ * lost: size the queue for the busiest frame, including the catch-up of big
+ * delta times, see {@link BaseTween#setCatchUpPolicy()}.
+ *
+ * @see TweenManager
+ */
+
+#ifndef __TweenEventQueue__
+#define __TweenEventQueue__
+
+#include <atomic>
+
+#include "BaseTween.h"
+#include "RingBuffer.h"
+
+namespace TweenEngine
+{
+    /**
+     * A recorded callback event. The source is only guaranteed to be alive
+     * until the next update of its manager, since finished tweens are freed
+     * there: use the handle and the user data to identify it afterwards.
+     */
+    struct TweenEvent
+    {
+        int type;
+        int count;                  // occurrences, see TweenCallback#onEvents()
+        BaseTween *source;
+        TweenHandle handle;         // target handle of the source, if any
+        void *userData;
+        TweenCallback *callback;
+    };
+
+    class TweenEventQueue
+    {
+    private:
+        RingBuffer<TweenEvent> events;
+        std::atomic<int> overflowCnt;
+
+    public:
+        TweenEventQueue(int capacity);
+
+        bool push(const TweenEvent &event);
+        bool pop(TweenEvent &event);
+        int dispatch();
+
+        int getCapacity();
+        int getOverflowCount();
+    };
+}
+
+#endif /* defined(__TweenEventQueue__) */
@@ -0,0 +1,53 @@
+//
+//  TweenExecutor.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A TweenExecutor runs the parallel update of a {@link TweenManager}. The
+ * engine provides {@link TweenThreadPool}, but you can plug your own job
+ * system by inheriting from this class.
+ * <p/>
+ *
+ * <b>Concurrency contract of a parallel update:</b><br/>
+ * - every tween or timeline is updated by exactly one thread,<br/>
+ * - accessors and callbacks of <i>different</i> tweens may run concurrently,
+ * so tweens sharing a target object need a thread-safe accessor,<br/>
+ * - callbacks must not add, kill, resume or free objects of the manager being
+ * updated, nor create tweens from its {@link TweenArena}, which is not
+ * thread-safe. Tweens and timelines of the global pools can be created and
+ * freed, and changes to the manager posted to a {@link TweenCommandQueue},<br/>
+ * - the removal of finished objects and their return to the pool always
+ * happen on the thread calling {@link TweenManager#update()}.
+ *
+ * @see TweenManager
+ * @see TweenThreadPool
+ */
+
+#ifndef __TweenExecutor__
+#define __TweenExecutor__
+
+#include <functional>
+
+namespace TweenEngine
+{
+    class TweenExecutor
+    {
+    public:
+        virtual ~TweenExecutor() {}
+        
+        /**
+         * Calls task(begin, end) on sub-ranges covering [0, count) exactly
+         * once, possibly in parallel, and returns when all of them are done.
+         *
+         * @param count The number of items.
+         * @param grainSize The preferred number of items per sub-range.
+         * @param task The work to do on a sub-range.
+         */
+        virtual void parallelFor(int count, int grainSize, const std::function<void(int, int)> &task) = 0;
+    };
+}
+
+#endif /* defined(__TweenExecutor__) */
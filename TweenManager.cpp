@@ -7,6 +7,17 @@
 
 #include "TweenManager.h"
 #include "BaseTween.h"
+#include "Tween.h"
+#include "TweenExecutor.h"
+#include "TweenEventQueue.h"
+#include "TweenCommandQueue.h"
+#include "TweenSnapshot.h"
+#include "TweenArena.h"
+#include "TweenTracer.h"
+
+#ifdef TWEEN_ENGINE_STATS
+#include <chrono>
+#endif
 
 namespace TweenEngine
 {
@@ -24,7 +35,7 @@ namespace TweenEngine
      */
     void TweenManager::setAutoRemove(BaseTween &object, bool value)
     {
-        object.isAutoRemoveEnabled = value;
+        object.setFlag(BaseTween::AUTO_REMOVE, value);
     }
     
     /**
@@ -35,10 +46,10 @@ namespace TweenEngine
      */
     void TweenManager::setAutoStart(BaseTween &object, bool value)
     {
-        object.isAutoStartEnabled = value;
+        object.setFlag(BaseTween::AUTO_START, value);
     }
     
-    int getTweensCount(std::vector<BaseTween *> objs)
+    int getTweensCount(std::vector<BaseTween *> &objs)
     {
 		int cnt = 0;
 		for (int i=0, n=(int)objs.size(); i<n; i++)
@@ -48,7 +59,7 @@ namespace TweenEngine
 		return cnt;
 	}
     
-	int getTimelinesCount(std::vector<BaseTween *> objs)
+	int getTimelinesCount(std::vector<BaseTween *> &objs)
     {
 		int cnt = 0;
 		for (int i=0, n=(int)objs.size(); i<n; i++)
@@ -58,44 +69,559 @@ namespace TweenEngine
 		return cnt;
 	}
     
-    bool isTweenFinished(BaseTween *obj)
+    // Takes finished objects out of the loop, to be freed at the next update
+    // (or once the rollback window has passed) so that they stay valid for
+    // their callbacks and events, as well as paused ones (kept dormant)
+    bool TweenManager::isTweenRemoved(BaseTween *obj)
     {
-        if (obj->isFinished() && obj->isAutoRemoveEnabled)
+        if (obj->isFinished() && obj->hasFlag(BaseTween::AUTO_REMOVE))
+        {
+            detach(obj);
+            return true;
+        }
+        if (obj->hasFlag(BaseTween::PAUSED))
         {
-            obj->free();
+            makeDormant(obj);
             return true;
         }
         return false;
     }
 
+    // The id stops designating the object right away, but is kept by the
+    // object until it is freed
+    void TweenManager::detach(BaseTween *obj)
+    {
+        Slot *slot = findSlot(obj->cold.id);
+        if (slot != NULL) slot->object = NULL;
+        
+        RemovedObject entry;
+        entry.object = obj;
+        entry.id = obj->cold.id;
+        entry.expiry = updateCnt + 1 + (unsigned)rollbackWindow;
+        removed.push_back(entry);
+    }
+
+    void TweenManager::freeRemoved()
+    {
+        updateCnt++;
+        
+        // Entries are sorted on expiry
+        int cnt = 0;
+        for (int n=(int)removed.size(); cnt<n && (int)(updateCnt - removed[cnt].expiry) >= 0; cnt++)
+        {
+            RemovedObject &entry = removed[cnt];
+            releaseId(entry.id);
+            if (entry.object->cold.id != entry.id) continue; // added again since
+            entry.object->callFree();
+            if (tracer != NULL) tracer->traceObject("free", entry.id);
+        }
+        TWEEN_STATS_COUNT(freedCnt, cnt);
+        if (cnt > 0) removed.erase(removed.begin(), removed.begin() + cnt);
+    }
+
+    // Tweens of the arena are only ended, their memory goes with the arena reset
+    void TweenManager::release(BaseTween *obj)
+    {
+        bool isTween = obj->kind == BaseTween::KIND_TWEEN || obj->kind == BaseTween::KIND_CALL;
+        if (arena != NULL && isTween && arena->drop(static_cast<Tween *>(obj))) return;
+        obj->callFree();
+    }
+
+    /**
+     * Updates the objects of the loop, or only commits them, forward or
+     * backward depending on the sign of delta, and compacts the loop in place
+     * as it goes: finished objects are removed and paused ones put aside.
+     * Objects added meanwhile by callbacks are kept after the swept ones.
+     */
+    void TweenManager::sweep(TweenTime delta, int pass)
+    {
+        int n = (int)objects.size();
+        int keptCnt = 0;
+        TweenTime eventTime = -1;
+        isSweeping = true;
+        
+        if (delta >= 0)
+        {
+            for (int i=0; i<n; i++)
+            {
+                BaseTween *obj = objects[i];
+                if (obj->hasFlag(BaseTween::UNLOOPED)) { dropUnlooped(obj); continue; }
+                if (pass == SWEEP_UPDATE) obj->update(delta);
+                else if (pass == SWEEP_COMMIT) obj->commitUpdate(delta);
+                if (isTweenRemoved(obj)) continue;
+                eventTime = getEarliest(eventTime, getEventTime(obj));
+                objects[keptCnt++] = obj;
+            }
+            if (keptCnt < n) objects.erase(objects.begin() + keptCnt, objects.begin() + n);
+        }
+        else
+        {
+            // Kept objects are packed at the end of the swept range
+            for (int i=n-1; i>=0; i--)
+            {
+                BaseTween *obj = objects[i];
+                if (obj->hasFlag(BaseTween::UNLOOPED)) { dropUnlooped(obj); continue; }
+                if (pass == SWEEP_UPDATE) obj->update(delta);
+                else if (pass == SWEEP_COMMIT) obj->commitUpdate(delta);
+                if (isTweenRemoved(obj)) continue;
+                eventTime = getEarliest(eventTime, getEventTime(obj));
+                objects[n - ++keptCnt] = obj;
+            }
+            if (keptCnt < n) objects.erase(objects.begin(), objects.begin() + (n - keptCnt));
+        }
+        
+        // Entries of objects parked by callbacks after the sweep passed them,
+        // or added by callbacks and parked again
+        isSweeping = false;
+        dropUnloopedEntries();
+        
+        activeEventTime = getEarliest(activeEventTime, eventTime);
+    }
+    
+    void TweenManager::dropUnlooped(BaseTween *obj)
+    {
+        obj->setFlag(BaseTween::UNLOOPED, false);
+        unloopedCnt--;
+    }
+    
+    // Objects parked again by add() keep their loop entry, so that the loop
+    // is not shifted for each of them. Their entries are dropped at once by
+    // the next sweep, or by this pass before the loop is walked otherwise.
+    void TweenManager::dropUnloopedEntries()
+    {
+        if (unloopedCnt == 0 || isSweeping) return;
+        int cnt = 0;
+        for (int i=0, n=(int)objects.size(); i<n; i++)
+        {
+            if (objects[i]->hasFlag(BaseTween::UNLOOPED)) dropUnlooped(objects[i]);
+            else objects[cnt++] = objects[i];
+        }
+        objects.resize(cnt);
+    }
+
+    /**
+     * Gets the time until the object next changes: 0 while it plays, the
+     * time left before its delay or repeat delay ends, or -1 if it won't
+     * change by itself (not started, paused or finished).
+     */
+    TweenTime TweenManager::getEventTime(BaseTween *obj)
+    {
+        uint16_t flags = obj->flags;
+        if ((flags & (BaseTween::STARTED|BaseTween::PAUSED|BaseTween::KILLED|BaseTween::FINISHED)) != BaseTween::STARTED) return -1;
+        if (obj->kind != BaseTween::KIND_TWEEN && obj->kind != BaseTween::KIND_CALL) return 0;
+        
+        TweenTime time;
+        if ((flags & BaseTween::INITIALIZED) == 0) time = obj->delayStart - obj->currentTime;
+        else if ((flags & BaseTween::ITERATION_STEP) == 0) time = obj->repeatDelay - obj->currentTime;
+        else return 0;
+        return time > 0 ? time : 0;
+    }
+    
+    // Minimum of two event times, -1 meaning none
+    TweenTime TweenManager::getEarliest(TweenTime time1, TweenTime time2)
+    {
+        if (time1 < 0) return time2;
+        if (time2 < 0) return time1;
+        return time1 < time2 ? time1 : time2;
+    }
+
+    // -------------------------------------------------------------------------
+	// Parking
+	// -------------------------------------------------------------------------
+
+    // Started objects still waiting for their start delay are kept out of the
+    // update loop, in a min-heap ordered by the manager clock at which their
+    // delay ends. Their local time is caught up when they wake up, so a
+    // frame only costs the active objects plus the ones waking up. Each one
+    // knows its index in the heap, see BaseTween::Cold, so that it can be
+    // taken out of it in logarithmic time when killed or paused.
+
+    bool TweenManager::isParkedLater(const ParkedObject &a, const ParkedObject &b)
+    {
+        return a.wakeClock > b.wakeClock;
+    }
+
+    void TweenManager::placeParked(int index, const ParkedObject &entry)
+    {
+        parked[index] = entry;
+        entry.object->cold.parkedIndex = index;
+    }
+
+    // Moves the entry at the given index up or down to its place in the heap
+    void TweenManager::siftParked(int index)
+    {
+        ParkedObject entry = parked[index];
+        int n = (int)parked.size();
+        
+        while (index > 0 && parked[(index-1)/2].wakeClock > entry.wakeClock)
+        {
+            placeParked(index, parked[(index-1)/2]);
+            index = (index-1)/2;
+        }
+        
+        while (2*index+1 < n)
+        {
+            int child = 2*index+1;
+            if (child+1 < n && parked[child+1].wakeClock < parked[child].wakeClock) child++;
+            if (parked[child].wakeClock >= entry.wakeClock) break;
+            placeParked(index, parked[child]);
+            index = child;
+        }
+        
+        placeParked(index, entry);
+    }
+
+    void TweenManager::removeParkedAt(int index)
+    {
+        int last = (int)parked.size()-1;
+        if (index < last) placeParked(index, parked[last]);
+        parked.pop_back();
+        if (index < last) siftParked(index);
+    }
+
+    void TweenManager::park(BaseTween *obj)
+    {
+        ParkedObject entry;
+        entry.wakeClock = clock + (double)(obj->delayStart - obj->currentTime);
+        entry.parkClock = clock;
+        entry.parkTime = obj->currentTime;
+        entry.object = obj;
+        
+        obj->cold.manager = this;
+        obj->setFlag(BaseTween::PARKED, true);
+        parked.push_back(entry);
+        siftParked((int)parked.size()-1);
+    }
+
+    void TweenManager::unparkAt(int index)
+    {
+        ParkedObject &entry = parked[index];
+        BaseTween *obj = entry.object;
+        obj->currentTime = entry.parkTime + (TweenTime)(clock - entry.parkClock);
+        obj->setFlag(BaseTween::PARKED, false);
+        obj->cold.parkedIndex = -1;
+        
+        // Parked during the sweep in progress, its loop entry is still there
+        if (obj->hasFlag(BaseTween::UNLOOPED)) dropUnlooped(obj);
+        else objects.push_back(obj);
+    }
+
+    /**
+     * Takes an object out of the heap before its delay ends, when it is
+     * killed or paused, from BaseTween.
+     */
+    void TweenManager::unpark(BaseTween *obj)
+    {
+        int index = obj->cold.parkedIndex;
+        unparkAt(index);
+        removeParkedAt(index);
+    }
+
+    void TweenManager::unparkTarget(TweenHandle tweenHandle)
+    {
+        int keptCnt = 0;
+        for (int i=0, n=(int)parked.size(); i<n; i++)
+        {
+            if (parked[i].object->callContainsTarget(tweenHandle)) unparkAt(i);
+            else placeParked(keptCnt++, parked[i]);
+        }
+        
+        if (keptCnt == (int)parked.size()) return;
+        parked.resize(keptCnt);
+        std::make_heap(parked.begin(), parked.end(), isParkedLater);
+        for (int i=0; i<keptCnt; i++) parked[i].object->cold.parkedIndex = i;
+    }
+
+    /**
+     * Moves to the update loop the objects whose delay ends during the next
+     * delta, then advances the clock.
+     */
+    void TweenManager::wakeParked(TweenTime delta)
+    {
+        double nextClock = clock + (double)delta;
+        
+        while (!parked.empty() && parked.front().wakeClock <= nextClock)
+        {
+            unparkAt(0);
+            removeParkedAt(0);
+        }
+        
+        clock = nextClock;
+    }
+
+    // -------------------------------------------------------------------------
+	// Dormant objects
+	// -------------------------------------------------------------------------
+
+    // Paused objects leave the loop during the removal sweep following their
+    // pause, and come back at the end of the update order as soon as they
+    // are resumed or killed, from BaseTween. Both moves are constant time:
+    // the dormant set is unordered and each object knows its index in it.
+
+    void TweenManager::makeDormant(BaseTween *obj)
+    {
+        obj->cold.manager = this;
+        obj->cold.dormantIndex = (int)dormant.size();
+        obj->setFlag(BaseTween::DORMANT, true);
+        dormant.push_back(obj);
+    }
+
+    void TweenManager::wakeDormant(BaseTween *obj)
+    {
+        BaseTween *last = dormant.back();
+        dormant[obj->cold.dormantIndex] = last;
+        last->cold.dormantIndex = obj->cold.dormantIndex;
+        dormant.pop_back();
+        
+        obj->cold.dormantIndex = -1;
+        obj->setFlag(BaseTween::DORMANT, false);
+        objects.push_back(obj);
+        activeEventTime = getEarliest(activeEventTime, getEventTime(obj));
+    }
+
+    // -------------------------------------------------------------------------
+	// Handle table
+	// -------------------------------------------------------------------------
+
+    // Slots are allocated by chunks that are never moved nor freed before the
+    // manager, so that ids can be reserved from any thread while the update
+    // thread reads the table. Free slots form a lock-free stack, its head is
+    // tagged against ABA.
+
+    TweenManager::Slot *TweenManager::getSlot(uint32_t index)
+    {
+        uint32_t chunk = index / SLOTS_CHUNK_SIZE;
+        if (chunk >= (uint32_t)SLOTS_CHUNKS_LIMIT) return NULL;
+        Slot *slots = slotChunks[chunk].load(std::memory_order_acquire);
+        return slots != NULL ? &slots[index % SLOTS_CHUNK_SIZE] : NULL;
+    }
+
+    TweenManager::Slot *TweenManager::findSlot(TweenId id)
+    {
+        uint32_t index = (uint32_t)id;
+        if (index == 0 || index > slotsCnt.load(std::memory_order_acquire)) return NULL;
+        Slot *slot = getSlot(index-1);
+        if (slot == NULL || slot->generation.load(std::memory_order_acquire) != (uint32_t)(id >> 32)) return NULL;
+        return slot;
+    }
+
+    void TweenManager::releaseId(TweenId id)
+    {
+        Slot *slot = findSlot(id);
+        if (slot == NULL) return;
+        
+        slot->object = NULL;
+        uint32_t generation = slot->generation.load(std::memory_order_relaxed) + 1;
+        slot->generation.store(generation != 0 ? generation : 1, std::memory_order_release);
+        
+        uint64_t head = freeSlotsHead.load(std::memory_order_relaxed);
+        uint64_t next;
+        do
+        {
+            slot->nextFree.store((uint32_t)head, std::memory_order_relaxed);
+            next = (((head >> 32) + 1) << 32) | (uint32_t)id;
+        }
+        while (!freeSlotsHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+    }
+
     // -------------------------------------------------------------------------
 	// API
 	// -------------------------------------------------------------------------
 
-    TweenManager::TweenManager() : objects()
+    TweenManager::TweenManager() : objects(), stats(), totalStats()
     {
         objects.reserve(20);
+        clock = 0;
+        activeEventTime = -1;
+        updateCnt = 0;
+        rollbackWindow = 0;
 		nextTweenHandle = 1;
+        slotChunks = new std::atomic<Slot *>[SLOTS_CHUNKS_LIMIT];
+        for (int i=0; i<SLOTS_CHUNKS_LIMIT; i++) slotChunks[i].store(NULL, std::memory_order_relaxed);
+        slotsCnt = 0;
+        freeSlotsHead = 0;
+        executor = NULL;
+        parallelGrainSize = 256;
+        isTwoPhase = false;
+        eventQueue = NULL;
+        isEventQueueDispatched = false;
+        commandQueue = NULL;
+        arena = NULL;
+        tracer = NULL;
+        isSweeping = false;
+        unloopedCnt = 0;
+    }
+
+    TweenManager::~TweenManager()
+    {
+        if (arena != NULL)
+        {
+            clear();
+            delete arena;
+        }
+        for (int i=0; i<SLOTS_CHUNKS_LIMIT; i++) delete[] slotChunks[i].load(std::memory_order_relaxed);
+        delete[] slotChunks;
     }
 
+    /**
+     * Gets a new target handle, unique for this manager. Safe to call from
+     * any thread.
+     */
 	TweenHandle TweenManager::getNextTweenHandle()
 	{
-		return nextTweenHandle++;
+		return nextTweenHandle.fetch_add(1, std::memory_order_relaxed);
 	}
 
     /**
-	 * Adds a tween or timeline to the manager and starts or restarts it.
+	 * Adds a tween or timeline to the manager and starts or restarts it. The
+	 * object is given an id, see {@link #get()}.
 	 *
 	 * @return The manager, for instruction chaining.
 	 */
-	TweenManager &TweenManager::add(BaseTween &object)
+	TweenManager &TweenManager::add(BaseTween &object) { return add(object, 0); }
+
+    /**
+	 * Adds a tween or timeline to the manager under an id previously obtained
+	 * from {@link #reserveId()}, and starts or restarts it. A new id is given
+	 * if the id is 0.
+	 *
+	 * @return The manager, for instruction chaining.
+	 */
+	TweenManager &TweenManager::add(BaseTween &object, TweenId id)
     {
-        bool isPresent = (std::find(objects.begin(), objects.end(), &object) != objects.end());
-		if (!isPresent) objects.push_back(&object);
-		if (object.isAutoStartEnabled) object.start();
+        // The handle table tells in O(1) if the object is already managed
+        bool isPresent = object.cold.id != 0 && get(object.cold.id) == &object;
+		if (isPresent && object.hasFlag(BaseTween::PARKED)) unpark(&object);
+		if (isPresent && object.hasFlag(BaseTween::DORMANT)) wakeDormant(&object);
+		if (!isPresent)
+        {
+            if (id == 0) id = reserveId();
+            Slot *slot = findSlot(id);
+            if (slot != NULL) slot->object = &object;
+            object.cold.id = slot != NULL ? id : 0;
+        }
+		object.cold.eventQueue = eventQueue;
+		if (object.hasFlag(BaseTween::AUTO_START)) object.start();
+        
+        // Objects starting with a delay wait out of the update loop
+        bool isDelayed = (object.flags & (BaseTween::STARTED|BaseTween::INITIALIZED|BaseTween::PAUSED|BaseTween::KILLED)) == BaseTween::STARTED
+            && object.delayStart > object.currentTime;
+		if (isDelayed)
+        {
+            // The loop entry stays, flagged, until it is dropped along with
+            // the others, see dropUnloopedEntries()
+            if (isPresent) { object.setFlag(BaseTween::UNLOOPED, true); unloopedCnt++; }
+            park(&object);
+        }
+        else
+        {
+            if (!isPresent) objects.push_back(&object);
+            activeEventTime = getEarliest(activeEventTime, getEventTime(&object));
+        }
+        if (tracer != NULL) tracer->traceObject("add", object.cold.id);
 		return *this;
 	}
 
+    /**
+     * Reserves an id for an object that will be added later, so that other
+     * threads can refer to a tween they posted to a
+     * {@link TweenCommandQueue} before it is actually created. Safe to call
+     * from any thread. A reserved id must be used by an add() call, or its
+     * slot is never reused. Returns 0 if the table is full.
+     */
+    TweenId TweenManager::reserveId()
+    {
+        uint64_t head = freeSlotsHead.load(std::memory_order_acquire);
+        while ((uint32_t)head != 0)
+        {
+            Slot *slot = getSlot((uint32_t)head - 1);
+            uint64_t next = (((head >> 32) + 1) << 32) | slot->nextFree.load(std::memory_order_relaxed);
+            if (freeSlotsHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return ((TweenId)slot->generation.load(std::memory_order_relaxed) << 32) | (uint32_t)head;
+            }
+        }
+        
+        uint32_t index = slotsCnt.fetch_add(1, std::memory_order_acq_rel);
+        uint32_t chunk = index / SLOTS_CHUNK_SIZE;
+        if (chunk >= (uint32_t)SLOTS_CHUNKS_LIMIT) return 0;
+        
+        Slot *slots = slotChunks[chunk].load(std::memory_order_acquire);
+        if (slots == NULL)
+        {
+            Slot *newSlots = new Slot[SLOTS_CHUNK_SIZE];
+            for (int i=0; i<SLOTS_CHUNK_SIZE; i++)
+            {
+                newSlots[i].generation.store(1, std::memory_order_relaxed);
+                newSlots[i].nextFree.store(0, std::memory_order_relaxed);
+                newSlots[i].object = NULL;
+            }
+            if (slotChunks[chunk].compare_exchange_strong(slots, newSlots, std::memory_order_acq_rel)) slots = newSlots;
+            else delete[] newSlots;
+        }
+        
+        return ((TweenId)slots[index % SLOTS_CHUNK_SIZE].generation.load(std::memory_order_relaxed) << 32) | (index+1);
+    }
+
+    /**
+     * Gets the object added under the given id in constant time, or NULL if
+     * it was removed since (its id is then stale) or is not added yet. Unlike
+     * a reference kept on a tween, an id never silently designates another
+     * object once the pool recycles it. Must be called on the update thread.
+     */
+    BaseTween *TweenManager::get(TweenId id)
+    {
+        Slot *slot = findSlot(id);
+        return slot != NULL ? slot->object : NULL;
+    }
+
+    /**
+     * Kills the object of the given id. Returns false if the id is stale.
+     */
+    bool TweenManager::kill(TweenId id)
+    {
+        BaseTween *obj = get(id);
+        if (obj == NULL) return false;
+        obj->kill();
+        return true;
+    }
+
+    /**
+     * Pauses the object of the given id. Returns false if the id is stale.
+     */
+    bool TweenManager::pause(TweenId id)
+    {
+        BaseTween *obj = get(id);
+        if (obj == NULL) return false;
+        obj->pause();
+        return true;
+    }
+
+    /**
+     * Resumes the object of the given id. Returns false if the id is stale.
+     */
+    bool TweenManager::resume(TweenId id)
+    {
+        BaseTween *obj = get(id);
+        if (obj == NULL) return false;
+        obj->resume();
+        if (!obj->hasFlag(BaseTween::PARKED)) activeEventTime = getEarliest(activeEventTime, getEventTime(obj));
+        return true;
+    }
+
+    /**
+     * Changes the target values of the tween of the given id, see
+     * {@link Tween#retarget()}. Returns false if the id is stale or does not
+     * designate a tween.
+     */
+    bool TweenManager::retarget(TweenId id, const float *targetValues, int len)
+    {
+        BaseTween *obj = get(id);
+        if (obj == NULL || obj->kind != BaseTween::KIND_TWEEN) return false;
+        static_cast<Tween *>(obj)->retarget(targetValues, len);
+        return true;
+    }
+
     /**
     * Returns true if the manager contains any valid interpolation associated
     * to the given target object.
@@ -107,7 +633,15 @@ namespace TweenEngine
 		for (int i=0, n=(int)objects.size(); i<n; i++)
         {
             BaseTween *obj = objects[i];
-            if (obj->containsTarget(tweenHandle)) return true;
+            if (obj->callContainsTarget(tweenHandle)) return true;
+        }
+		for (int i=0, n=(int)parked.size(); i<n; i++)
+        {
+            if (parked[i].object->callContainsTarget(tweenHandle)) return true;
+        }
+		for (int i=0, n=(int)dormant.size(); i<n; i++)
+        {
+            if (dormant[i]->callContainsTarget(tweenHandle)) return true;
         }
         return false;
     }
@@ -122,8 +656,61 @@ namespace TweenEngine
 			BaseTween *obj = objects[i];
 			obj->kill();
 		}
+        
+        // Parked objects go back to the loop to be removed
+		for (int i=0, n=(int)parked.size(); i<n; i++)
+        {
+			BaseTween *obj = parked[i].object;
+			unparkAt(i);
+			obj->kill();
+		}
+		parked.clear();
+        
+        // So are dormant ones, kill() wakes them up
+		while (!dormant.empty()) dormant.back()->kill();
 	}
 
+    /**
+     * Removes every tween and timeline, without any callback, and frees
+     * them. Linear in the number of objects: each one gets its id released
+     * and is freed, or destroyed for the tweens of the arena, whose memory
+     * is then given back at once by resetting the arena. Events still
+     * waiting in a {@link TweenEventQueue} must be dispatched before. Must
+     * not be called during an update.
+     */
+    void TweenManager::clear()
+    {
+        dropUnloopedEntries();
+        for (int i=0, n=(int)removed.size(); i<n; i++)
+        {
+            RemovedObject &entry = removed[i];
+            releaseId(entry.id);
+            if (entry.object->cold.id == entry.id) release(entry.object); // unless added again since
+        }
+        for (int i=0, n=(int)objects.size(); i<n; i++)
+        {
+            releaseId(objects[i]->cold.id);
+            release(objects[i]);
+        }
+        for (int i=0, n=(int)parked.size(); i<n; i++)
+        {
+            releaseId(parked[i].object->cold.id);
+            release(parked[i].object);
+        }
+        for (int i=0, n=(int)dormant.size(); i<n; i++)
+        {
+            releaseId(dormant[i]->cold.id);
+            release(dormant[i]);
+        }
+        
+        removed.clear();
+        objects.clear();
+        parked.clear();
+        dormant.clear();
+        activeEventTime = -1;
+        if (arena != NULL) arena->reset();
+    }
+
     /**
     * Kills every tweens associated to the given target. Will also kill every
     * timelines containing a tween associated to the given target.
@@ -132,17 +719,151 @@ namespace TweenEngine
     void TweenManager::killTarget(TweenHandle tweenHandle)
     {
 		if (tweenHandle == INVALID_TWEEN_HANDLE) return;
+        unparkTarget(tweenHandle);
         for (int i=0, n=(int)objects.size(); i<n; i++)
         {
             BaseTween *obj = objects[i];
             obj->killTarget(tweenHandle);
         }
+        
+        // Killed dormant objects are swapped out of the set, hence backward
+        for (int i=(int)dormant.size()-1; i>=0; i--)
+        {
+            if (i < (int)dormant.size()) dormant[i]->killTarget(tweenHandle);
+        }
+    }
+
+    /**
+    * Pauses every tweens associated to the given target.
+    */
+    void TweenManager::pauseTarget(TweenHandle tweenHandle)
+    {
+		if (tweenHandle == INVALID_TWEEN_HANDLE) return;
+        unparkTarget(tweenHandle);
+        for (int i=0, n=(int)objects.size(); i<n; i++)
+        {
+            BaseTween *obj = objects[i];
+            if (obj->callContainsTarget(tweenHandle)) obj->pause();
+        }
     }
 
     /**
-	 * Increases the minimum capacity of the manager. Defaults to 20.
+    * Resumes every tweens associated to the given target.
+    */
+    void TweenManager::resumeTarget(TweenHandle tweenHandle)
+    {
+		if (tweenHandle == INVALID_TWEEN_HANDLE) return;
+        for (int i=0, n=(int)objects.size(); i<n; i++)
+        {
+            BaseTween *obj = objects[i];
+            if (!obj->callContainsTarget(tweenHandle)) continue;
+            obj->resume();
+            activeEventTime = getEarliest(activeEventTime, getEventTime(obj));
+        }
+        
+        // Resumed dormant objects are swapped out of the set, hence backward
+        for (int i=(int)dormant.size()-1; i>=0; i--)
+        {
+            if (i < (int)dormant.size() && dormant[i]->callContainsTarget(tweenHandle)) dormant[i]->resume();
+        }
+    }
+
+    /**
+     * Gets the arena owned by the manager, created on the first call. Tweens
+     * created from it, see {@link Tween#to(TweenArena &, ...)}, are kept
+     * close to each other in memory and away from the global pool, and
+     * their memory is given back at once by {@link #clear()} or when the
+     * manager is destroyed. They must not be added to another manager.
+     */
+    TweenArena &TweenManager::getArena()
+    {
+        if (arena == NULL) arena = new TweenArena(TweenArena::DEFAULT_CHUNK_SIZE);
+        return *arena;
+    }
+
+    /**
+	 * Increases the minimum capacity of the manager. Defaults to 20. The
+	 * lists of delayed and removed objects get the same capacity, so that
+	 * updates don't allocate as long as the manager holds at most that many
+	 * objects.
+	 */
+	void TweenManager::ensureCapacity(int minCapacity)
+    {
+        objects.reserve(minCapacity);
+        parked.reserve(minCapacity);
+        removed.reserve(minCapacity);
+    }
+    
+	/**
+	 * Enables the parallel update mode: objects are split in chunks updated
+	 * concurrently by the given executor, usually a {@link TweenThreadPool}.
+	 * Read the concurrency contract of {@link TweenExecutor} before enabling
+	 * it. Pass NULL to go back to the serial update (default). The executor
+	 * is not owned by the manager.
+	 */
+	void TweenManager::setExecutor(TweenExecutor *executor) { this->executor = executor; }
+    
+	/**
+	 * Changes the number of objects updated per parallel chunk. Managers with
+	 * fewer objects than this are always updated serially. Defaults to 256.
+	 */
+	void TweenManager::setParallelGrainSize(int grainSize) { parallelGrainSize = grainSize > 0 ? grainSize : 1; }
+    
+	/**
+	 * Enables the two-phase update mode. Each update first computes the new
+	 * values of every object without touching any target nor firing any
+	 * callback (in parallel if an executor was set), then commits them in a
+	 * single serial pass, in the usual forward or backward order. Objects
+	 * that have to cross a boundary are fully updated during the commit, so
+	 * callbacks and accessors always run on the calling thread and may
+	 * freely share state. Changes made from a callback to another object,
+	 * such as a pause, take effect at the next update; a kill is honored
+	 * right away. Defaults to false.
 	 */
-	void TweenManager::ensureCapacity(int minCapacity) { objects.reserve(minCapacity); }
+	void TweenManager::setTwoPhaseUpdate(bool value) { isTwoPhase = value; }
+    
+	/**
+	 * Defers the callbacks of the managed objects: instead of being called
+	 * from the middle of the update loop, their events are recorded in the
+	 * given queue. If isDispatchedOnUpdate is true, the queue is dispatched
+	 * in one pass at the end of every update. Otherwise, the caller drains it
+	 * with {@link TweenEventQueue#pop()}, possibly from another thread. Pass
+	 * NULL to go back to direct calls (default). The queue is not owned by
+	 * the manager.
+	 */
+	void TweenManager::setEventQueue(TweenEventQueue *queue, bool isDispatchedOnUpdate)
+    {
+		eventQueue = queue;
+		isEventQueueDispatched = isDispatchedOnUpdate;
+		for (int i=0, n=(int)objects.size(); i<n; i++) objects[i]->cold.eventQueue = queue;
+		for (int i=0, n=(int)parked.size(); i<n; i++) parked[i].object->cold.eventQueue = queue;
+		for (int i=0, n=(int)dormant.size(); i<n; i++) dormant[i]->cold.eventQueue = queue;
+	}
+    
+	/**
+	 * Lets other threads spawn, kill or pause tweens through the given queue.
+	 * Its commands are executed at the start of every update, on the update
+	 * thread. Pass NULL to detach it (default). The queue is not owned by the
+	 * manager.
+	 */
+	void TweenManager::setCommandQueue(TweenCommandQueue *queue) { commandQueue = queue; }
+    
+	/**
+	 * Keeps the objects removed by the updates alive, and their id reserved,
+	 * for the given number of extra updates, so that a snapshot taken up to
+	 * that many updates before can still bring them back, see
+	 * {@link #restore()}. Defaults to 0: removed objects are freed at the
+	 * next update.
+	 */
+	void TweenManager::setRollbackWindow(int updates) { rollbackWindow = updates > 0 ? updates : 0; }
+    
+	/**
+	 * Records the update phases and the life-cycle of the managed objects in
+	 * the given tracer, see {@link TweenTracer}. Pass NULL to stop tracing
+	 * (default). The tracer is not owned by the manager, and may be shared
+	 * by several managers.
+	 */
+	void TweenManager::setTracer(TweenTracer *tracer) { this->tracer = tracer; }
     
 	/**
 	 * Pauses the manager. Further update calls won't have any effect.
@@ -154,10 +875,39 @@ namespace TweenEngine
 	 */
 	void TweenManager::resume() { isPaused = false; }
     
+#ifdef TWEEN_ENGINE_STATS
+    // Seconds since the given time, which is moved to now
+    static double lapWallTime(double &time)
+    {
+        double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        double lap = now - time;
+        time = now;
+        return lap;
+    }
+    
+    // Adds the stats of the update that just ended to the total
+    static void addStats(TweenStats &total, const TweenStats &stats)
+    {
+        total.visitedCnt += stats.visitedCnt;
+        total.initializedCnt += stats.initializedCnt;
+        total.crossingCnt += stats.crossingCnt;
+        total.readCnt += stats.readCnt;
+        total.writeCnt += stats.writeCnt;
+        total.callbackCnt += stats.callbackCnt;
+        total.freedCnt += stats.freedCnt;
+        total.freeTime += stats.freeTime;
+        total.commandTime += stats.commandTime;
+        total.wakeTime += stats.wakeTime;
+        total.updateTime += stats.updateTime;
+        total.dispatchTime += stats.dispatchTime;
+    }
+#endif
+    
 	/**
 	 * Updates every tweens with a delta time ang handles the tween life-cycles
 	 * automatically. If a tween is finished, it will be removed from the
-	 * manager. The delta time represents the elapsed time between now and the
+	 * manager by the same update, and freed at the start of the next one, so
+	 * that it stays valid for its callbacks until then. The delta time represents the elapsed time between now and the
 	 * last update call. Each tween or timeline manages its local time, and adds
 	 * this delta to its local time to update itself.
 	 * <p/>
@@ -165,26 +915,200 @@ namespace TweenEngine
 	 * Slow motion, fast motion and backward play can be easily achieved by
 	 * tweaking this delta time. Multiply it by -1 to play the animation
 	 * backward, or by 0.5 to play it twice slower than its normal speed.
+	 * <p/>
+	 *
+	 * If an executor was set, see {@link setExecutor()}, the objects are
+	 * updated in parallel. See {@link setTwoPhaseUpdate()} to keep callbacks
+	 * and accessors on the calling thread, and {@link setEventQueue()} to
+	 * call the callbacks after the update.
+	 * <p/>
+	 *
+	 * Objects added with a start delay are kept out of the update loop until
+	 * their delay ends, then join the end of the update order. So are paused
+	 * objects, until they are resumed or killed.
 	 */
    
-	void TweenManager::update(float delta)
+	void TweenManager::update(TweenTime delta)
     {
-        // Remove tweens that are finished
-        objects.erase(std::remove_if(objects.begin(),objects.end(),isTweenFinished), objects.end());
+        TWEEN_STATS(TweenStats start = TweenStats::local(); stats = TweenStats());
+        TWEEN_STATS(double time = 0; lapWallTime(time));
+        
+        // Objects reach the tracer of the update through the thread
+        TweenTracer *previousTracer = TweenTracer::setCurrent(tracer);
+        int64_t updateStart = tracer != NULL ? TweenTracer::now() : 0;
+        int64_t phaseStart = updateStart;
         
-		if (!isPaused)
+        // Free the objects removed by the previous update
+        freeRemoved();
+        TWEEN_STATS(stats.freeTime = lapWallTime(time));
+        if (tracer != NULL) phaseStart = tracer->tracePhase("free", phaseStart);
+        
+        // Apply the commands posted by other threads
+        if (commandQueue != NULL) commandQueue->drain(*this);
+        TWEEN_STATS(stats.commandTime = lapWallTime(time));
+        if (tracer != NULL) phaseStart = tracer->tracePhase("commands", phaseStart);
+        
+        // Objects added by callbacks during the sweep update activeEventTime
+        // themselves, the sweep merges the time of the updated ones
+        activeEventTime = -1;
+        
+		if (isPaused)
+        {
+            sweep(0, SWEEP_REMOVE);
+            TWEEN_STATS(stats.updateTime = lapWallTime(time); collectStats(start); addStats(totalStats, stats));
+            if (tracer != NULL) tracer->tracePhase("TweenManager::update", updateStart);
+            TweenTracer::setCurrent(previousTracer);
+            return;
+        }
+        
+        dropUnloopedEntries();
+        wakeParked(delta);
+        TWEEN_STATS_COUNT(visitedCnt, objects.size());
+        TWEEN_STATS(stats.wakeTime = lapWallTime(time));
+        if (tracer != NULL) phaseStart = tracer->tracePhase("wake", phaseStart);
+        
+		if (isTwoPhase)
         {
-			if (delta >= 0)
+            // Phase one: compute only, each object touches its own state
+            BaseTween **objs = objects.data();
+            int n = (int)objects.size();
+            if (executor != NULL && n > parallelGrainSize)
             {
-				for (int i=0, n=(int)objects.size(); i<n; i++) objects[i]->update(delta);
-			}
+                executor->parallelFor(n, parallelGrainSize, [this, objs, delta](int begin, int end)
+                {
+                    TWEEN_STATS(TweenStats start = TweenStats::local());
+                    int64_t chunkStart = tracer != NULL ? TweenTracer::now() : 0;
+                    for (int i=begin; i<end; i++) objs[i]->computeUpdate(delta);
+                    if (tracer != NULL) tracer->tracePhase("compute chunk", chunkStart);
+                    TWEEN_STATS(collectStats(start));
+                });
+            }
             else
             {
-				for (int i=(int)objects.size()-1; i>=0; i--) objects[i]->update(delta);
-			}
+                for (int i=0; i<n; i++) objs[i]->computeUpdate(delta);
+            }
+            
+            // Phase two: commit serially, callbacks may add objects
+            if (tracer != NULL) phaseStart = tracer->tracePhase("compute", phaseStart);
+            sweep(delta, SWEEP_COMMIT);
 		}
+		else if (executor != NULL && (int)objects.size() > parallelGrainSize)
+        {
+            // Objects are independent, so the backward order doesn't matter
+            // when they are updated in parallel. Removal stays serial.
+            BaseTween **objs = objects.data();
+            executor->parallelFor((int)objects.size(), parallelGrainSize, [this, objs, delta](int begin, int end)
+            {
+                TWEEN_STATS(TweenStats start = TweenStats::local());
+                TweenTracer *previousTracer = TweenTracer::setCurrent(tracer);
+                int64_t chunkStart = tracer != NULL ? TweenTracer::now() : 0;
+                for (int i=begin; i<end; i++) objs[i]->update(delta);
+                if (tracer != NULL) tracer->tracePhase("update chunk", chunkStart);
+                TweenTracer::setCurrent(previousTracer);
+                TWEEN_STATS(collectStats(start));
+            });
+            sweep(delta, SWEEP_REMOVE);
+        }
+        else
+        {
+            sweep(delta, SWEEP_UPDATE);
+        }
+        TWEEN_STATS(stats.updateTime = lapWallTime(time));
+        if (tracer != NULL) phaseStart = tracer->tracePhase("update", phaseStart);
+        
+		if (eventQueue != NULL && isEventQueueDispatched) eventQueue->dispatch();
+        TWEEN_STATS(stats.dispatchTime = lapWallTime(time); collectStats(start); addStats(totalStats, stats));
+        
+        if (tracer != NULL)
+        {
+            tracer->tracePhase("dispatch", phaseStart);
+            tracer->tracePhase("TweenManager::update", updateStart);
+        }
+        TweenTracer::setCurrent(previousTracer);
 	}
     
+	/**
+	 * Moves every managed object to the given manager time, see
+	 * {@link getTime()}, forward or backward, as a single update would. The
+	 * callbacks of the skipped events are not called, see
+	 * {@link #seek(double, int)} to have them coalesced instead.
+	 */
+	void TweenManager::seek(double time) { seek(time, BaseTween::SEEK_SILENT); }
+    
+	/**
+	 * Moves every managed object to the given manager time, see
+	 * {@link getTime()}, with {@link BaseTween#seek()}. Paused objects are
+	 * left as they are, but the manager itself may be paused. As with an
+	 * update, objects finished by the seek, including the ones sought back
+	 * before their start, are removed unless auto-remove was disabled.
+	 *
+	 * @param policy SEEK_SILENT or SEEK_COALESCE, see BaseTween.
+	 */
+	void TweenManager::seek(double time, int policy)
+    {
+        freeRemoved();
+        activeEventTime = -1;
+        
+        TweenTime delta = (TweenTime)(time - clock);
+        wakeParked(delta);
+        
+        // Callbacks may add objects, see sweep()
+        isSweeping = true;
+        for (int i=0, n=(int)objects.size(); i<n; i++)
+        {
+            BaseTween *obj = objects[i];
+            if (!obj->isPaused() && !obj->hasFlag(BaseTween::UNLOOPED)) obj->seek(obj->getPosition() + delta, policy);
+        }
+        sweep(delta, SWEEP_REMOVE);
+        
+		if (eventQueue != NULL && isEventQueueDispatched) eventQueue->dispatch();
+	}
+    
+	/**
+	 * Gets the manager time: the sum of the deltas of the updates made while
+	 * it was not paused, moved by the seeks.
+	 */
+	double TweenManager::getTime() { return clock; }
+    
+	/**
+	 * Gets the time until anything managed next changes, so that hosts can
+	 * stop updating and sleep until then. Returns 0 if some object is
+	 * playing and needs regular updates, the time left before the earliest
+	 * delay or repeat delay ends, or -1 if nothing will change by itself
+	 * (everything is paused, finished or not started, or the manager is
+	 * paused). Constant time: kept up to date by update() and by the add,
+	 * resume and parking operations. Parked objects killed or paused are
+	 * taken out of the heap on the way.
+	 * <p/>
+	 *
+	 * Times are relative to the last update. Objects resumed directly with
+	 * {@link BaseTween#resume()} are only seen at the next update.
+	 */
+	TweenTime TweenManager::nextEventTime()
+    {
+		if (isPaused) return -1;
+		TweenTime time = activeEventTime;
+        
+        // Killed or paused objects never wake up, they go back to the loop
+        // to be removed or made dormant
+        while (!parked.empty() && (parked.front().object->flags & (BaseTween::KILLED|BaseTween::PAUSED)) != 0)
+        {
+            unpark(parked.front().object);
+        }
+		if (!parked.empty())
+        {
+            TweenTime wait = (TweenTime)(parked.front().wakeClock - clock);
+            time = getEarliest(time, wait > 0 ? wait : 0);
+        }
+		return time;
+	}
+    
+	/**
+	 * Returns true if no object needs to be updated right now. See
+	 * {@link #nextEventTime()} to know for how long.
+	 */
+	bool TweenManager::isIdle() { return nextEventTime() != 0; }
+    
 	/**
 	 * Gets the number of managed objects. An object may be a tween or a
 	 * timeline. Note that a timeline only counts for 1 object, since it
@@ -192,7 +1116,257 @@ namespace TweenEngine
 	 * <p/>
 	 * To get the count of running tweens, see {@link #getRunningTweensCount()}.
 	 */
-	size_t TweenManager::size() { return objects.size(); }
+	size_t TweenManager::size() { return objects.size() - unloopedCnt + parked.size() + dormant.size(); }
+    
+    // -------------------------------------------------------------------------
+	// Statistics
+	// -------------------------------------------------------------------------
+
+    // Moves the counters of the calling thread since start to the stats of
+    // the update. They are rewound, so that a parallel chunk run by the
+    // updating thread is not counted again by the update itself. The last
+    // call of an update is made by update() itself.
+    void TweenManager::collectStats(const TweenStats &start)
+    {
+        TweenStats &local = TweenStats::local();
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.visitedCnt += local.visitedCnt - start.visitedCnt;
+        stats.initializedCnt += local.initializedCnt - start.initializedCnt;
+        stats.crossingCnt += local.crossingCnt - start.crossingCnt;
+        stats.readCnt += local.readCnt - start.readCnt;
+        stats.writeCnt += local.writeCnt - start.writeCnt;
+        stats.callbackCnt += local.callbackCnt - start.callbackCnt;
+        stats.freedCnt += local.freedCnt - start.freedCnt;
+        local = start;
+    }
+
+	/**
+	 * Gets the work done by the last update, see {@link TweenStats}. Always
+	 * 0 unless the engine is built with TWEEN_ENGINE_STATS.
+	 */
+	const TweenStats &TweenManager::getStats() { return stats; }
+    
+	/**
+	 * Gets the work done by the updates since the manager was created or
+	 * {@link #resetStats()} was called.
+	 */
+	const TweenStats &TweenManager::getTotalStats() { return totalStats; }
+    
+	/**
+	 * Sets the stats of the last update and the total back to 0.
+	 */
+	void TweenManager::resetStats()
+    {
+        stats = TweenStats();
+        totalStats = TweenStats();
+    }
+    
+    // -------------------------------------------------------------------------
+	// Snapshots
+	// -------------------------------------------------------------------------
+
+    // A header (magic, total size, object counts, clock), then a record per
+    // managed object, loop first, then parked and dormant ones: its id, the
+    // size of the rest of the record and its kind, the parking clock of
+    // parked objects, and the state of the object, see BaseTween#saveState().
+    // Objects are found back through their ids, the buffer holds no pointer.
+    // Parked objects are not updated, the time they were parked at is their
+    // saved current time.
+
+	/**
+	 * Saves the state of every managed object and the manager clock into the
+	 * given buffer, without allocating, for a later {@link #restore()}.
+	 * Returns the size of the snapshot: if it is greater than the capacity,
+	 * the buffer is incomplete, retry with a buffer that large.
+	 * <p/>
+	 *
+	 * Saved: the timing state of the objects, the values, equation and path
+	 * of the tweens, and the state of the timeline children. Not saved: the
+	 * targets themselves, the configuration of the objects (callbacks,
+	 * accessors...) and the queued events and commands.
+	 */
+	size_t TweenManager::snapshot(void *buffer, size_t capacity)
+    {
+        dropUnloopedEntries();
+        TweenSnapshotWriter writer(buffer, capacity);
+        writer.write((uint32_t)SNAPSHOT_MAGIC);
+        writer.write((uint64_t)0);
+        writer.write((uint32_t)objects.size());
+        writer.write((uint32_t)parked.size());
+        writer.write((uint32_t)dormant.size());
+        writer.write(clock);
+        
+        for (int i=0, n=(int)objects.size(); i<n; i++) saveObject(writer, objects[i], NULL);
+        for (int i=0, n=(int)parked.size(); i<n; i++) saveObject(writer, parked[i].object, &parked[i]);
+        for (int i=0, n=(int)dormant.size(); i<n; i++) saveObject(writer, dormant[i], NULL);
+        
+        writer.patch(sizeof(uint32_t), (uint64_t)writer.getSize());
+        return writer.getSize();
+    }
+
+    void TweenManager::saveObject(TweenSnapshotWriter &writer, BaseTween *obj, const ParkedObject *parkedObject)
+    {
+        writer.write(obj->cold.id);
+        size_t sizePosition = writer.getSize();
+        writer.write((uint32_t)0);
+        writer.write((uint32_t)obj->kind);
+        
+        if (parkedObject != NULL) writer.write(parkedObject->parkClock);
+        obj->saveState(writer);
+        
+        writer.patch(sizePosition, (uint32_t)(writer.getSize() - sizePosition - 2*sizeof(uint32_t)));
+    }
+
+	/**
+	 * Brings the manager back to a snapshot taken by {@link #snapshot()}:
+	 * objects get their saved state back, along with their id and their
+	 * place in the update order, objects removed since are brought back and
+	 * objects added since are removed. Meant for rollback: save every frame,
+	 * restore and replay the frames when a late input arrives. Does not
+	 * allocate, unless more objects are managed than ever before.
+	 * <p/>
+	 *
+	 * Returns false, leaving the manager untouched, if the buffer is not a
+	 * complete snapshot or if an object of the snapshot was freed since: see
+	 * {@link #setRollbackWindow()} to keep removed objects alive long enough.
+	 * The targets are not written, the next update does it.
+	 */
+	bool TweenManager::restore(const void *buffer, size_t size)
+    {
+        TweenSnapshotReader reader(buffer, size);
+        uint32_t magic, objectsCnt, parkedCnt, dormantCnt;
+        uint64_t snapshotSize;
+        double snapshotClock;
+        reader.read(magic);
+        reader.read(snapshotSize);
+        reader.read(objectsCnt);
+        reader.read(parkedCnt);
+        reader.read(dormantCnt);
+        reader.read(snapshotClock);
+        if (!reader.isValid() || magic != SNAPSHOT_MAGIC || snapshotSize != size) return false;
+        dropUnloopedEntries();
+        
+        // Every managed or removed object is marked, and the objects of the
+        // snapshot are unmarked while the records are checked, so that the
+        // ones left out can be removed. An object is alive as long as its id
+        // is not released: the slots of the removed objects designate them
+        // again meanwhile, so that every record is resolved by its slot.
+        for (int i=0, n=(int)objects.size(); i<n; i++) objects[i]->setFlag(BaseTween::UNSAVED, true);
+        for (int i=0, n=(int)parked.size(); i<n; i++) parked[i].object->setFlag(BaseTween::UNSAVED, true);
+        for (int i=0, n=(int)dormant.size(); i<n; i++) dormant[i]->setFlag(BaseTween::UNSAVED, true);
+        int removedCnt = (int)removed.size();
+        for (int i=0; i<removedCnt; i++)
+        {
+            Slot *slot = findSlot(removed[i].id);
+            if (slot != NULL && slot->object == NULL) slot->object = removed[i].object;
+            removed[i].object->setFlag(BaseTween::UNSAVED, true);
+        }
+        
+        size_t recordsPosition = reader.getPosition();
+        uint32_t recordsCnt = objectsCnt + parkedCnt + dormantCnt;
+        BaseTween *obj = NULL;
+        TweenId id = 0;
+        uint32_t recordSize = 0, kind = 0;
+        bool isValid = true;
+        
+        for (uint32_t i=0; i<recordsCnt && isValid; i++)
+        {
+            reader.read(id);
+            reader.read(recordSize);
+            reader.read(kind);
+            obj = get(id);
+            isValid = reader.skip(recordSize) && obj != NULL && obj->kind == kind;
+            if (isValid) obj->setFlag(BaseTween::UNSAVED, false);
+        }
+        
+        if (!isValid || reader.getPosition() != size)
+        {
+            for (int i=0, n=(int)objects.size(); i<n; i++) objects[i]->setFlag(BaseTween::UNSAVED, false);
+            for (int i=0, n=(int)parked.size(); i<n; i++) parked[i].object->setFlag(BaseTween::UNSAVED, false);
+            for (int i=0, n=(int)dormant.size(); i<n; i++) dormant[i]->setFlag(BaseTween::UNSAVED, false);
+            for (int i=0; i<removedCnt; i++)
+            {
+                if (get(removed[i].id) == removed[i].object) findSlot(removed[i].id)->object = NULL;
+                removed[i].object->setFlag(BaseTween::UNSAVED, false);
+            }
+            return false;
+        }
+        
+        auto drop = [this](BaseTween *obj)
+        {
+            if (!obj->hasFlag(BaseTween::UNSAVED)) return;
+            obj->flags = (obj->flags & ~(BaseTween::UNSAVED|BaseTween::PARKED|BaseTween::DORMANT)) | BaseTween::KILLED;
+            detach(obj);
+        };
+        for (int i=0, n=(int)objects.size(); i<n; i++) drop(objects[i]);
+        for (int i=0, n=(int)parked.size(); i<n; i++) drop(parked[i].object);
+        for (int i=0, n=(int)dormant.size(); i<n; i++) drop(dormant[i]);
+        
+        // Then the objects get their state, id and place back
+        objects.clear();
+        parked.clear();
+        dormant.clear();
+        reader.rewind(recordsPosition);
+        
+        for (uint32_t i=0; i<recordsCnt; i++)
+        {
+            reader.read(id);
+            reader.read(recordSize);
+            reader.read(kind);
+            obj = get(id);
+            
+            // Added again under another id since, that one is removed
+            if (obj->cold.id != id && get(obj->cold.id) == obj) detach(obj);
+            obj->cold.id = id;
+            
+            if (i < objectsCnt)
+            {
+                obj->restoreState(reader);
+                objects.push_back(obj);
+            }
+            else if (i < objectsCnt + parkedCnt)
+            {
+                ParkedObject entry;
+                reader.read(entry.parkClock);
+                obj->restoreState(reader);
+                entry.parkTime = obj->currentTime;
+                entry.wakeClock = entry.parkClock + (double)(obj->delayStart - obj->currentTime);
+                entry.object = obj;
+                obj->cold.manager = this;
+                obj->cold.parkedIndex = (int)parked.size();
+                parked.push_back(entry);
+            }
+            else
+            {
+                obj->restoreState(reader);
+                obj->cold.manager = this;
+                obj->cold.dormantIndex = (int)dormant.size();
+                dormant.push_back(obj);
+            }
+        }
+        
+        // Removed objects brought back are not freed anymore, the slots of
+        // the other ones designate nothing again. Restored objects got their
+        // flags back, unmarked.
+        for (int i=0; i<removedCnt; i++)
+        {
+            RemovedObject &entry = removed[i];
+            bool isBack = !entry.object->hasFlag(BaseTween::UNSAVED) && entry.object->cold.id == entry.id;
+            if (!isBack && get(entry.id) == entry.object) findSlot(entry.id)->object = NULL;
+        }
+        int keptCnt = 0;
+        for (int i=0, n=(int)removed.size(); i<n; i++)
+        {
+            removed[i].object->setFlag(BaseTween::UNSAVED, false);
+            if (get(removed[i].id) != removed[i].object) removed[keptCnt++] = removed[i];
+        }
+        removed.resize(keptCnt);
+        
+        clock = snapshotClock;
+        activeEventTime = -1;
+        for (int i=0, n=(int)objects.size(); i<n; i++) activeEventTime = getEarliest(activeEventTime, getEventTime(objects[i]));
+        return true;
+    }
     
 	/**
 	 * Gets the number of running tweens. This number includes the tweens
@@ -200,7 +1374,14 @@ namespace TweenEngine
 	 * <p/>
 	 * <b>Provided for debug purpose only.</b>
 	 */
-	int TweenManager::getRunningTweensCount() { return getTweensCount(objects); }
+	int TweenManager::getRunningTweensCount()
+    {
+        dropUnloopedEntries();
+		int cnt = getTweensCount(objects);
+		for (int i=0, n=(int)parked.size(); i<n; i++) cnt += parked[i].object->getTweenCount();
+		cnt += getTweensCount(dormant);
+		return cnt;
+	}
     
 	/**
 	 * Gets the number of running timelines. This number includes the timelines
@@ -208,15 +1389,24 @@ namespace TweenEngine
 	 * <p/>
 	 * <b>Provided for debug purpose only.</b>
 	 */
-	int TweenManager::getRunningTimelinesCount() { return getTimelinesCount(objects); }
+	int TweenManager::getRunningTimelinesCount()
+    {
+        dropUnloopedEntries();
+		int cnt = getTimelinesCount(objects);
+		for (int i=0, n=(int)parked.size(); i<n; i++) cnt += parked[i].object->getTimelineCount();
+		cnt += getTimelinesCount(dormant);
+		return cnt;
+	}
     
 	/**
-	 * Gets a list of every managed object.
+	 * Gets a list of every managed object in the update loop. Objects still
+	 * waiting for their start delay and paused ones are not listed.
 	 * <p/>
 	 * <b>Provided for debug purpose only.</b>
 	 */
     std::vector<BaseTween *> &TweenManager::getObjects()
     {
+        dropUnloopedEntries();
 		return objects;
 	}
 
@@ -23,23 +23,135 @@
 #define __TweenManager__
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 #include "BaseTween.h"
+#include "TweenStats.h"
 
 namespace TweenEngine
 {
+    class TweenExecutor;
+    class TweenEventQueue;
+    class TweenCommandQueue;
+    class TweenSnapshotWriter;
+    class TweenArena;
+    class TweenTracer;
+    
     class TweenManager
     {
+        friend class BaseTween;
+
     private:
         std::vector<BaseTween *>objects;
 
+        // Paused objects, out of the update loop until resumed or killed.
+        // Each one knows its index, see BaseTween::Cold.
+        std::vector<BaseTween *> dormant;
+
+        // Objects removed by the updates, freed once the rollback window has
+        // passed. Their id is only released then, so that a snapshot taken
+        // meanwhile can bring them back.
+        struct RemovedObject
+        {
+            BaseTween *object;
+            TweenId id;
+            unsigned expiry;        // update count at which it is freed
+        };
+        std::vector<RemovedObject> removed;
+        unsigned updateCnt;
+        int rollbackWindow;
+
+        // Objects waiting for their start delay, in a min-heap on wakeClock
+        struct ParkedObject
+        {
+            double wakeClock;
+            double parkClock;
+            TweenTime parkTime;
+            BaseTween *object;
+        };
+        std::vector<ParkedObject> parked;
+        double clock;
+
+        // Earliest change among the objects of the loop, as of the last update
+        TweenTime activeEventTime;
+
         bool isPaused = false;
 
-		TweenHandle		nextTweenHandle;
+        // Set while the loop is walked. Objects parked meanwhile, or parked
+        // again by add(), keep their entry, flagged UNLOOPED, until the
+        // sweep drops it.
+        bool isSweeping;
+        int unloopedCnt;
+
+        TweenExecutor *executor;
+        int parallelGrainSize;
+        bool isTwoPhase;
+        TweenEventQueue *eventQueue;
+        bool isEventQueueDispatched;
+        TweenCommandQueue *commandQueue;
+        TweenArena *arena;
+        TweenTracer *tracer;
+
+        // Work of the last update and since the last reset, see TweenStats
+        TweenStats stats;
+        TweenStats totalStats;
+        std::mutex statsMutex;
+
+		std::atomic<TweenHandle> nextTweenHandle;
+
+        // Handle table, see get()
+        struct Slot
+        {
+            std::atomic<uint32_t> generation;
+            std::atomic<uint32_t> nextFree;     // index+1 of the next free slot
+            BaseTween *object;
+        };
+        static const int SLOTS_CHUNK_SIZE = 4096;
+        static const int SLOTS_CHUNKS_LIMIT = 1024;
+
+        std::atomic<Slot *> *slotChunks;
+        std::atomic<uint32_t> slotsCnt;
+        std::atomic<uint64_t> freeSlotsHead;    // tag << 32 | index+1
+
+        Slot *getSlot(uint32_t index);
+        Slot *findSlot(TweenId id);
+        void releaseId(TweenId id);
+        static const int SWEEP_REMOVE = 0;
+        static const int SWEEP_UPDATE = 1;
+        static const int SWEEP_COMMIT = 2;
+
+        bool isTweenRemoved(BaseTween *obj);
+        void detach(BaseTween *obj);
+        void freeRemoved();
+        void release(BaseTween *obj);
+        void sweep(TweenTime delta, int pass);
+        void dropUnlooped(BaseTween *obj);
+        void dropUnloopedEntries();
+        static TweenTime getEventTime(BaseTween *obj);
+        static TweenTime getEarliest(TweenTime time1, TweenTime time2);
+
+        static bool isParkedLater(const ParkedObject &a, const ParkedObject &b);
+        void placeParked(int index, const ParkedObject &entry);
+        void siftParked(int index);
+        void removeParkedAt(int index);
+        void park(BaseTween *obj);
+        void unpark(BaseTween *obj);
+        void unparkAt(int index);
+        void unparkTarget(TweenHandle tweenHandle);
+        void wakeParked(TweenTime delta);
+        void makeDormant(BaseTween *obj);
+        void wakeDormant(BaseTween *obj);
+
+        static const uint32_t SNAPSHOT_MAGIC = 0x54574e31; // "TWN1"
+        void saveObject(TweenSnapshotWriter &writer, BaseTween *obj, const ParkedObject *parkedObject);
+
+        void collectStats(const TweenStats &start);
 
     public:
         TweenManager();
+        ~TweenManager();
         
 		static const TweenHandle INVALID_TWEEN_HANDLE = 0;
 
@@ -47,14 +159,42 @@ namespace TweenEngine
         static void setAutoStart(BaseTween &object, bool value);
         
         TweenManager &add(BaseTween &object);
+        TweenManager &add(BaseTween &object, TweenId id);
+        TweenId reserveId();
+        BaseTween *get(TweenId id);
+        bool kill(TweenId id);
+        bool pause(TweenId id);
+        bool resume(TweenId id);
+        bool retarget(TweenId id, const float *targetValues, int len);
         bool containsTarget(TweenHandle tweenHandle);
         void killAll();
+        void clear();
         void killTarget(TweenHandle tweenHandle);
+        void pauseTarget(TweenHandle tweenHandle);
+        void resumeTarget(TweenHandle tweenHandle);
         void ensureCapacity(int minCapacity);
+        void setExecutor(TweenExecutor *executor);
+        void setParallelGrainSize(int grainSize);
+        void setTwoPhaseUpdate(bool value);
+        void setEventQueue(TweenEventQueue *queue, bool isDispatchedOnUpdate);
+        void setCommandQueue(TweenCommandQueue *queue);
+        void setRollbackWindow(int updates);
+        void setTracer(TweenTracer *tracer);
+        TweenArena &getArena();
         void pause();
         void resume();
-        void update(float delta);
+        void update(TweenTime delta);
+        void seek(double time);
+        void seek(double time, int policy);
+        double getTime();
+        TweenTime nextEventTime();
+        bool isIdle();
         size_t size();
+        size_t snapshot(void *buffer, size_t capacity);
+        bool restore(const void *buffer, size_t size);
+        const TweenStats &getStats();
+        const TweenStats &getTotalStats();
+        void resetStats();
         
 		TweenHandle getNextTweenHandle();
 
@@ -0,0 +1,131 @@
+//
+//  TweenMath.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * Transcendental functions used by the equations. By default they forward
+ * to the standard library, whose results may differ in the last bits across
+ * compilers, standard libraries and CPUs.
+ * <p/>
+ *
+ * Define TWEEN_ENGINE_DETERMINISTIC for lockstep simulations: the engine
+ * then uses its own single precision approximations, made of +, -, *, / and
+ * sqrt only, which IEEE 754 requires to be correctly rounded. Results are
+ * bit-identical on every platform doing single precision math in SSE or
+ * NEON registers (no x87), as long as the compiler does not contract
+ * multiplications and additions into FMAs: build with -ffp-contract=off on
+ * GCC (the default of the ISO -std modes), clang is told so below, and
+ * MSVC does not contract under /fp:precise. Errors stay within a few ulps.
+ *
+ * @see TweenEquation
+ */
+
+#ifndef __TweenMath__
+#define __TweenMath__
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(TWEEN_ENGINE_DETERMINISTIC) && defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace TweenEngine
+{
+    namespace TweenMath
+    {
+#ifndef TWEEN_ENGINE_DETERMINISTIC
+
+        inline double sin(double x) { return ::sin(x); }
+        inline double cos(double x) { return ::cos(x); }
+        inline double asin(double x) { return ::asin(x); }
+        inline double sqrt(double x) { return ::sqrt(x); }
+        inline double exp2(double x) { return ::pow(2.0, x); }
+
+#else
+
+        // Cephes polynomials, on [-pi/4, pi/4]
+
+        inline float sinPoly(float x, float z)
+        {
+            return ((-1.9515295891E-4f*z + 8.3321608736E-3f)*z - 1.6666654611E-1f)*z*x + x;
+        }
+
+        inline float cosPoly(float z)
+        {
+            return ((2.443315711809948E-5f*z - 1.388731625493765E-3f)*z + 4.166664568298827E-2f)*z*z - 0.5f*z + 1.0f;
+        }
+
+        // Reduces |x| to [-pi/4, pi/4] around the nearest even multiple of
+        // pi/4, subtracted in three parts to stay exact. Returns that
+        // multiple, modulo 8.
+        inline int reduce(float &x)
+        {
+            int j = (int)(x * 1.27323954473516f);
+            j += j & 1;
+            float y = (float)j;
+            x = ((x - y*0.78515625f) - y*2.4187564849853515625e-4f) - y*3.77489497744594108e-8f;
+            return j & 7;
+        }
+
+        inline float sin(float x)
+        {
+            float sign = x < 0 ? -1.0f : 1.0f;
+            x *= sign;
+            int j = reduce(x);
+            if (j > 3) { sign = -sign; j -= 4; }
+            float z = x*x;
+            return sign * (j == 0 ? sinPoly(x, z) : cosPoly(z));
+        }
+
+        inline float cos(float x)
+        {
+            x = x < 0 ? -x : x;
+            int j = reduce(x);
+            float sign = 1.0f;
+            if (j > 3) { sign = -sign; j -= 4; }
+            if (j > 1) sign = -sign;
+            float z = x*x;
+            return sign * (j == 2 ? sinPoly(x, z) : cosPoly(z));
+        }
+
+        inline float sqrt(float x) { return sqrtf(x); }
+
+        inline float asin(float x)
+        {
+            float sign = x < 0 ? -1.0f : 1.0f;
+            float a = x*sign;
+            if (a > 1) a = 1;
+
+            bool isLarge = a > 0.5f;
+            float z = isLarge ? 0.5f*(1.0f - a) : a*a;
+            float y = isLarge ? sqrtf(z) : a;
+            float r = ((((4.2163199048E-2f*z + 2.4181311049E-2f)*z + 4.5470025998E-2f)*z + 7.4953002686E-2f)*z + 1.6666752422E-1f)*z*y + y;
+            return sign * (isLarge ? 1.5707963267948966f - (r + r) : r);
+        }
+
+        // 2^n * 2^f, n being the nearest integer and 2^n built from its bits
+        inline float exp2(float x)
+        {
+            if (x < -126.0f) return 0;
+            if (x > 127.0f) x = 127.0f;
+
+            int n = (int)(x + 126.5f) - 126;
+            float f = x - (float)n;
+            float p = (((((1.535336188319500E-4f*f + 1.339887440266574E-3f)*f + 9.618437357674640E-3f)*f + 5.550332471162809E-2f)*f + 2.402264791363012E-1f)*f + 6.931472028550421E-1f)*f + 1.0f;
+
+            uint32_t bits = (uint32_t)(n + 127) << 23;
+            float scale;
+            memcpy(&scale, &bits, sizeof(scale));
+            return p * scale;
+        }
+
+#endif
+    }
+}
+
+#endif /* defined(__TweenMath__) */
@@ -17,6 +17,7 @@ namespace TweenEngine
     
     void TweenPoolCallback::onUnPool(Tween *obj)
     {
+        obj->isPooled = false;
         obj->reset();
     }
     
@@ -0,0 +1,115 @@
+//
+//  TweenSnapshot.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * Sequential binary writer and reader of the state saved by
+ * {@link TweenManager#snapshot()}, on a buffer given by the caller. They never
+ * allocate. The writer never writes past the end of its buffer but keeps
+ * counting, so that the caller learns the size needed. The reader checks
+ * every read against the size of the snapshot, and stays failed after the
+ * first bad one.
+ * <p/>
+ *
+ * Values are copied as they are in memory: a snapshot is only meant to be
+ * restored by the process that took it. Blocks can be aligned relative to
+ * the start of the buffer, which is then best aligned on 8 bytes.
+ *
+ * @see TweenManager
+ */
+
+#ifndef __TweenSnapshot__
+#define __TweenSnapshot__
+
+#include <cstddef>
+#include <cstring>
+
+namespace TweenEngine
+{
+    class TweenSnapshotWriter
+    {
+    private:
+        char *buffer;
+        size_t capacity;
+        size_t size;
+
+    public:
+        TweenSnapshotWriter(void *buffer, size_t capacity) : buffer((char *)buffer), capacity(capacity), size(0) {}
+
+        void write(const void *data, size_t len)
+        {
+            if (len <= capacity && size <= capacity - len) memcpy(buffer + size, data, len);
+            size += len;
+        }
+
+        // Fixed size, so that the copy is inlined
+        template<typename T> void write(const T &value)
+        {
+            if (size + sizeof(T) <= capacity) memcpy(buffer + size, &value, sizeof(T));
+            size += sizeof(T);
+        }
+
+        // Pads with zeros up to a multiple of the given alignment
+        void align(size_t alignment)
+        {
+            while (size % alignment != 0) write((char)0);
+        }
+
+        // Overwrites a value written earlier, typically a size
+        template<typename T> void patch(size_t position, const T &value)
+        {
+            if (position + sizeof(T) <= capacity) memcpy(buffer + position, &value, sizeof(T));
+        }
+
+        size_t getSize() { return size; }
+        bool isOverflowed() { return size > capacity; }
+    };
+
+    class TweenSnapshotReader
+    {
+    private:
+        const char *buffer;
+        size_t size;
+        size_t position;
+        bool isFailed;
+
+    public:
+        TweenSnapshotReader(const void *buffer, size_t size) : buffer((const char *)buffer), size(size), position(0), isFailed(false) {}
+
+        bool read(void *data, size_t len)
+        {
+            if (isFailed || len > size - position) return fail();
+            memcpy(data, buffer + position, len);
+            position += len;
+            return true;
+        }
+
+        template<typename T> bool read(T &value)
+        {
+            if (isFailed || sizeof(T) > size - position) return fail();
+            memcpy(&value, buffer + position, sizeof(T));
+            position += sizeof(T);
+            return true;
+        }
+
+        bool skip(size_t len)
+        {
+            if (isFailed || len > size - position) return fail();
+            position += len;
+            return true;
+        }
+
+        bool align(size_t alignment) { return skip((alignment - position % alignment) % alignment); }
+
+        void rewind(size_t position) { this->position = position; }
+        bool fail() { isFailed = true; return false; }
+
+        size_t getPosition() { return position; }
+        bool isValid() { return !isFailed; }
+    };
+}
+
+#endif /* defined(__TweenSnapshot__) */
@@ -0,0 +1,66 @@
+//
+//  TweenStats.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * Counters of the work done by the updates of a {@link TweenManager}, to
+ * relate slow frames to bursts of new tweens, callbacks or accessor calls.
+ * They are only collected when the engine is built with TWEEN_ENGINE_STATS
+ * defined. Otherwise the instrumentation is compiled out, and every counter
+ * stays at 0.
+ * <p/>
+ *
+ * The thread doing the work increments its own counters, and the manager
+ * collects them at the end of each update, including the ones of the
+ * parallel chunks. An update running from a callback of another manager's
+ * update is counted by both managers.
+ *
+ * @see TweenManager#getStats()
+ */
+
+#ifndef __TweenStats__
+#define __TweenStats__
+
+#include <stdint.h>
+
+#ifdef TWEEN_ENGINE_STATS
+#define TWEEN_STATS(...) __VA_ARGS__
+#else
+#define TWEEN_STATS(...)
+#endif
+
+#define TWEEN_STATS_COUNT(counter, n) TWEEN_STATS(TweenEngine::TweenStats::local().counter += (uint64_t)(n))
+
+namespace TweenEngine
+{
+    struct TweenStats
+    {
+        uint64_t visitedCnt;        // objects of the update loop
+        uint64_t initializedCnt;    // objects reaching the end of their delay
+        uint64_t crossingCnt;       // iteration starts and ends crossed
+        uint64_t readCnt;           // accessor reads
+        uint64_t writeCnt;          // accessor writes
+        uint64_t callbackCnt;       // callbacks called or queued
+        uint64_t freedCnt;          // removed objects freed
+
+        // Wall time of the phases of the update, in seconds
+        double freeTime;            // freeing the objects removed before
+        double commandTime;         // draining the command queue
+        double wakeTime;            // waking the parked objects
+        double updateTime;          // updating and sweeping the loop
+        double dispatchTime;        // dispatching the event queue
+
+        // Counters of the calling thread. Kept trivial so that the thread
+        // local needs no initialization guard.
+        static TweenStats &local()
+        {
+            static thread_local TweenStats stats;
+            return stats;
+        }
+    };
+}
+
+#endif /* defined(__TweenStats__) */
@@ -0,0 +1,121 @@
+//
+//  TweenThreadPool.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "TweenThreadPool.h"
+
+namespace TweenEngine
+{
+    /**
+     * Creates a pool running parallel loops on the given number of threads,
+     * including the calling one. Use std::thread::hardware_concurrency() to
+     * match the number of cores. A count of 1 or less runs everything on the
+     * calling thread.
+     */
+    TweenThreadPool::TweenThreadPool(int threadsCnt)
+    {
+        partitionsCnt = threadsCnt > 1 ? threadsCnt : 1;
+        partitions = new Partition[partitionsCnt];
+        generation = 0;
+        busyWorkersCnt = 0;
+        isStopping = false;
+        task = NULL;
+        grainSize = 1;
+        
+        for (int i=1; i<partitionsCnt; i++)
+        {
+            threads.push_back(std::thread(&TweenThreadPool::workerLoop, this, i));
+        }
+    }
+    
+    TweenThreadPool::~TweenThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+        wakeCondition.notify_all();
+        for (size_t i=0; i<threads.size(); i++) threads[i].join();
+        delete[] partitions;
+    }
+    
+    /**
+     * Gets the number of threads running the loops, including the calling one.
+     */
+    int TweenThreadPool::getThreadsCount() { return partitionsCnt; }
+    
+    void TweenThreadPool::parallelFor(int count, int grainSize, const std::function<void(int, int)> &task)
+    {
+        if (grainSize < 1) grainSize = 1;
+        
+        if (threads.empty() || count <= grainSize)
+        {
+            if (count > 0) task(0, count);
+            return;
+        }
+        
+        for (int i=0; i<partitionsCnt; i++)
+        {
+            partitions[i].next.store((int)((long long)count*i/partitionsCnt), std::memory_order_relaxed);
+            partitions[i].end = (int)((long long)count*(i+1)/partitionsCnt);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->task = &task;
+            this->grainSize = grainSize;
+            busyWorkersCnt = (int)threads.size();
+            generation++;
+        }
+        wakeCondition.notify_all();
+        
+        runPartitions(0);
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        while (busyWorkersCnt > 0) doneCondition.wait(lock);
+        this->task = NULL;
+    }
+    
+    void TweenThreadPool::workerLoop(int index)
+    {
+        unsigned seenGeneration = 0;
+        
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!isStopping && generation == seenGeneration) wakeCondition.wait(lock);
+                if (isStopping) return;
+                seenGeneration = generation;
+            }
+            
+            runPartitions(index);
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkersCnt == 0) doneCondition.notify_one();
+        }
+    }
+    
+    /**
+     * Consumes the partition of the given thread, then steals from the
+     * other ones, starting with the next thread's.
+     */
+    void TweenThreadPool::runPartitions(int index)
+    {
+        for (int i=0; i<partitionsCnt; i++)
+        {
+            Partition &partition = partitions[(index+i) % partitionsCnt];
+            
+            while (true)
+            {
+                int begin = partition.next.fetch_add(grainSize, std::memory_order_relaxed);
+                if (begin >= partition.end) break;
+                int end = begin+grainSize < partition.end ? begin+grainSize : partition.end;
+                (*task)(begin, end);
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+//
+//  TweenThreadPool.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A small work-stealing thread pool, used as the {@link TweenExecutor} of
+ * parallel tween managers. The range of every parallelFor() call is split in
+ * one partition per thread (the calling thread takes part in the work). Each
+ * thread consumes chunks of its own partition, then steals chunks from the
+ * other partitions until everything is done. Chunks are claimed with a single
+ * atomic increment, workers only sleep between two calls.
+ *
+ * @see TweenExecutor
+ * @see TweenManager
+ */
+
+#ifndef __TweenThreadPool__
+#define __TweenThreadPool__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BaseTween.h"
+#include "TweenExecutor.h"
+
+namespace TweenEngine
+{
+    class TweenThreadPool : public TweenExecutor
+    {
+    private:
+        struct Partition
+        {
+            std::atomic<int> next;
+            int end;
+            char padding[BaseTween::CACHE_LINE_SIZE - sizeof(std::atomic<int>) - sizeof(int)];
+        };
+        
+        std::vector<std::thread> threads;
+        Partition *partitions;
+        int partitionsCnt;
+        
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable doneCondition;
+        unsigned generation;
+        int busyWorkersCnt;
+        bool isStopping;
+        
+        // Current job
+        const std::function<void(int, int)> *task;
+        int grainSize;
+        
+        void workerLoop(int index);
+        void runPartitions(int index);
+        
+    public:
+        TweenThreadPool(int threadsCnt);
+        ~TweenThreadPool();
+        
+        int getThreadsCount();
+        
+        virtual void parallelFor(int count, int grainSize, const std::function<void(int, int)> &task);
+    };
+}
+
+#endif /* defined(__TweenThreadPool__) */
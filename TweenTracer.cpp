@@ -0,0 +1,163 @@
+//
+//  TweenTracer.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include <chrono>
+#include <stdio.h>
+
+#include "TweenTracer.h"
+#include "TweenCallback.h"
+
+namespace TweenEngine
+{
+    // Small thread numbers, given on the first event of each thread
+    static std::atomic<int> threadsCnt(0);
+    static thread_local int threadIndex = 0;
+
+    static int getThreadIndex()
+    {
+        if (threadIndex == 0) threadIndex = threadsCnt.fetch_add(1, std::memory_order_relaxed) + 1;
+        return threadIndex;
+    }
+
+    /**
+     * Creates a tracer able to hold the given number of events, rounded up
+     * to the next power of two. Nothing is allocated after construction.
+     */
+    TweenTracer::TweenTracer(int capacity) : events(capacity)
+    {
+        droppedCnt.store(0, std::memory_order_relaxed);
+        origin = now();
+        longCallbackThreshold = 1000000;
+    }
+
+    /**
+     * Changes the duration from which a callback is recorded, in seconds.
+     * Defaults to 1 ms. Pass 0 to record every callback.
+     */
+    void TweenTracer::setLongCallbackThreshold(double seconds)
+    {
+        longCallbackThreshold = (int64_t)(seconds * 1e9);
+    }
+
+    /**
+     * Records an event going from start to end, both given by now(), or an
+     * instant event at start if end is -1. Safe to call from several
+     * threads at once. The oldest events are dropped to make room if needed.
+     */
+    void TweenTracer::record(const char *name, const char *category, int64_t start, int64_t end, TweenId id)
+    {
+        TweenTraceEvent event;
+        event.name = name;
+        event.category = category;
+        event.time = start - origin;
+        event.duration = end >= 0 ? end - start : -1;
+        event.id = id;
+        event.thread = getThreadIndex();
+
+        TweenTraceEvent oldest;
+        while (!events.push(event))
+        {
+            if (events.pop(oldest)) droppedCnt.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Records an update phase that started at the given time and ends now.
+     * Returns now, the start of the next phase.
+     */
+    int64_t TweenTracer::tracePhase(const char *name, int64_t start)
+    {
+        int64_t end = now();
+        record(name, "update", start, end, 0);
+        return end;
+    }
+
+    /**
+     * Records an instant event of the life-cycle of an object.
+     */
+    void TweenTracer::traceObject(const char *name, TweenId id)
+    {
+        record(name, "object", now(), -1, id);
+    }
+
+    /**
+     * Records a callback that started at the given time, if it lasted
+     * longer than the threshold.
+     */
+    void TweenTracer::traceCallback(int type, TweenId id, int64_t start)
+    {
+        int64_t end = now();
+        if (end - start >= longCallbackThreshold) record(getEventName(type), "callback", start, end, id);
+    }
+
+    /**
+     * Drains the recorded events and appends them to the given string, as
+     * a Chrome trace JSON document, to load in chrome://tracing or
+     * Perfetto. Returns the number of events.
+     */
+    int TweenTracer::dump(std::string &json)
+    {
+        char buffer[256];
+        TweenTraceEvent event;
+        int cnt = 0;
+
+        json += "{\"traceEvents\":[";
+        while (events.pop(event))
+        {
+            int len = snprintf(buffer, sizeof(buffer), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f",
+                cnt > 0 ? ",\n" : "\n", event.name, event.category, event.thread, event.time/1000.0);
+            json.append(buffer, len);
+
+            if (event.duration >= 0) len = snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"dur\":%.3f", event.duration/1000.0);
+            else len = snprintf(buffer, sizeof(buffer), ",\"ph\":\"i\",\"s\":\"t\"");
+            json.append(buffer, len);
+
+            if (event.id != 0) len = snprintf(buffer, sizeof(buffer), ",\"args\":{\"id\":%llu}}", (unsigned long long)event.id);
+            else len = snprintf(buffer, sizeof(buffer), "}");
+            json.append(buffer, len);
+            cnt++;
+        }
+        json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        return cnt;
+    }
+
+    int TweenTracer::getCapacity() { return events.capacity(); }
+
+    /**
+     * Gets the number of events dropped to make room for newer ones since
+     * the creation of the tracer.
+     */
+    int TweenTracer::getDroppedCount() { return droppedCnt.load(std::memory_order_relaxed); }
+
+    /**
+     * Gets the time of the steady clock, in nanoseconds.
+     */
+    int64_t TweenTracer::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Gets the name of a TweenCallback event type.
+     */
+    const char *TweenTracer::getEventName(int type)
+    {
+        switch (type)
+        {
+            case TweenCallback::BEGIN: return "BEGIN";
+            case TweenCallback::START: return "START";
+            case TweenCallback::END: return "END";
+            case TweenCallback::COMPLETE: return "COMPLETE";
+            case TweenCallback::BACK_BEGIN: return "BACK_BEGIN";
+            case TweenCallback::BACK_START: return "BACK_START";
+            case TweenCallback::BACK_END: return "BACK_END";
+            case TweenCallback::BACK_COMPLETE: return "BACK_COMPLETE";
+            default: return "callback";
+        }
+    }
+}
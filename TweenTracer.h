@@ -0,0 +1,104 @@
+//
+//  TweenTracer.h
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * A recorder of what a {@link TweenManager} does over time, for a timeline
+ * view of the frames in chrome://tracing or Perfetto. Once given to a
+ * manager, see {@link TweenManager#setTracer()}, it records:
+ * - the phases of every update, and the parallel chunks,
+ * - the life-cycle of the objects: add, initialize, every callback event
+ *   (BEGIN, START, END, COMPLETE and their BACK_ variants) and free,
+ * - the callbacks taking longer than a threshold, see
+ *   {@link #setLongCallbackThreshold()}.
+ * <p/>
+ *
+ * Events go to a preallocated lock-free ring buffer, so that parallel
+ * chunks can record at the same time. When it is full, the oldest events
+ * are dropped: memory stays bounded, and the buffer always holds the last
+ * frames, so the tracer can be left on. dump() drains it as Chrome trace
+ * JSON, possibly from another thread.
+ * <p/>
+ *
+ * Without a tracer, the only cost is a thread local pointer checked at
+ * each recording point, none of them on the path of a tween playing an
+ * iteration.
+ *
+ * @see TweenManager
+ */
+
+#ifndef __TweenTracer__
+#define __TweenTracer__
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+#include "BaseTween.h"
+#include "RingBuffer.h"
+
+namespace TweenEngine
+{
+    /**
+     * A recorded event. Names and categories are static strings.
+     */
+    struct TweenTraceEvent
+    {
+        const char *name;
+        const char *category;
+        int64_t time;               // nanoseconds, since the tracer creation
+        int64_t duration;           // nanoseconds, -1 for instant events
+        TweenId id;                 // managed object, if any
+        int thread;                 // index of the recording thread
+    };
+
+    class TweenTracer
+    {
+    private:
+        RingBuffer<TweenTraceEvent> events;
+        std::atomic<int> droppedCnt;
+        int64_t origin;
+        int64_t longCallbackThreshold;
+
+        TweenTracer(const TweenTracer &);
+        TweenTracer &operator=(const TweenTracer &);
+
+    public:
+        TweenTracer(int capacity);
+
+        void setLongCallbackThreshold(double seconds);
+
+        void record(const char *name, const char *category, int64_t start, int64_t end, TweenId id);
+        int64_t tracePhase(const char *name, int64_t start);
+        void traceObject(const char *name, TweenId id);
+        void traceCallback(int type, TweenId id, int64_t start);
+
+        int dump(std::string &json);
+        int getCapacity();
+        int getDroppedCount();
+
+        static int64_t now();
+        static const char *getEventName(int type);
+
+        // Tracer of the update running on the calling thread, if any
+        static TweenTracer *getCurrent() { return current(); }
+        static TweenTracer *setCurrent(TweenTracer *tracer)
+        {
+            TweenTracer *previous = current();
+            current() = tracer;
+            return previous;
+        }
+
+    private:
+        static TweenTracer *&current()
+        {
+            static thread_local TweenTracer *tracer = NULL;
+            return tracer;
+        }
+    };
+}
+
+#endif /* defined(__TweenTracer__) */
@@ -0,0 +1,944 @@
+//
+//  TweenBench.cpp
+//
+//  This code is derived from Universal Tween Engine
+//  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
+//
+
+/**
+ * Benchmarks of the engine hot paths. Every result is printed as a single
+ * line JSON object, {"bench", "case", "value", "unit"}, so that runs can be
+ * compared by scripts for regression tracking. Timings are the median of
+ * several runs.
+ * <p/>
+ *
+ * Checks come along, run by every invocation and failing the process when
+ * --check is given:
+ * - allocations: a warmed manager spawning, updating and seeking a mix of
+ *   tweens, timelines and commands must not allocate, counted through the
+ *   global operator new and the pool misses;
+ * - determinism: a digest of the equations and of a simulation, which must
+ *   match the reference one when built with TWEEN_ENGINE_DETERMINISTIC, and
+ *   is only printed otherwise;
+ * - readd: objects re-added with a delay by callbacks, while the update
+ *   walks the loop, must be parked once and play to their end;
+ * - clear: the accessors of the tweens of a cleared arena must all be
+ *   destroyed;
+ * - parked: delayed tweens paused or killed directly, through BaseTween,
+ *   must leave the parked heap like the ones paused or killed by id, and
+ *   must not be reported by nextEventTime().
+ * The allocation check also prints the per frame TweenStats of its workload
+ * when built with TWEEN_ENGINE_STATS. Each check is registered as a CTest
+ * test of the same name, run with --quick --check --filter, the
+ * determinism one in deterministic builds only.
+ * <p/>
+ *
+ * Usage: tween_bench [--quick] [--check] [--filter name]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Tween.h"
+#include "Timeline.h"
+#include "TweenArena.h"
+#include "TweenCommandQueue.h"
+#include "TweenEventQueue.h"
+#include "TweenManager.h"
+#include "TweenThreadPool.h"
+#include "TweenTracer.h"
+
+using namespace TweenEngine;
+
+// -----------------------------------------------------------------------------
+// Allocation counting
+// -----------------------------------------------------------------------------
+
+static std::atomic<long long> allocationsCnt(0);
+
+void *operator new(size_t size)
+{
+    allocationsCnt.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = malloc(size > 0 ? size : 1);
+    if (ptr == NULL) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    allocationsCnt.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size > 0 ? size : 1);
+}
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+// Tweens and timelines have their own aligned operator new, their creations
+// are the pool misses
+static long long countAllocations()
+{
+    return allocationsCnt.load(std::memory_order_relaxed)
+        + (long long)Tween::getPoolStats().misses + (long long)Timeline::getPoolStats().misses;
+}
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+static bool isQuick = false;
+static bool isCheck = false;
+static const char *filter = NULL;
+static bool isFailed = false;
+
+static volatile float sink;
+
+static void report(const char *bench, const std::string &name, double value, const char *unit)
+{
+    printf("{\"bench\": \"%s\", \"case\": \"%s\", \"value\": %.6g, \"unit\": \"%s\"}\n", bench, name.c_str(), value, unit);
+    fflush(stdout);
+}
+
+static bool isEnabled(const char *bench)
+{
+    return filter == NULL || strstr(bench, filter) != NULL;
+}
+
+static std::string format(const char *fmt, long long value)
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), fmt, value);
+    return buffer;
+}
+
+// Median duration of a run, in seconds
+template<typename Run>
+static double measure(Run run)
+{
+    int repetitions = isQuick ? 3 : 7;
+    std::vector<double> times;
+    for (int i=0; i<repetitions; i++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        run();
+        times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size()/2];
+}
+
+static TweenAccessor makeAccessor(float *target, int cnt)
+{
+    return [target, cnt](int mode, float *values)
+    {
+        if (mode == Tween::ACCESSOR_READ) for (int i=0; i<cnt; i++) values[i] = target[i];
+        else for (int i=0; i<cnt; i++) target[i] = values[i];
+        return cnt;
+    };
+}
+
+struct Equation
+{
+    const char *name;
+    TweenEquation *equation;
+};
+
+static std::vector<Equation> getEquations()
+{
+    Equation equations[] = {
+        {"Linear.INOUT", &TweenEquations::easeInOutLinear},
+        {"Quad.IN", &TweenEquations::easeInQuad}, {"Quad.OUT", &TweenEquations::easeOutQuad}, {"Quad.INOUT", &TweenEquations::easeInOutQuad},
+        {"Cubic.IN", &TweenEquations::easeInCubic}, {"Cubic.OUT", &TweenEquations::easeOutCubic}, {"Cubic.INOUT", &TweenEquations::easeInOutCubic},
+        {"Quart.IN", &TweenEquations::easeInQuart}, {"Quart.OUT", &TweenEquations::easeOutQuart}, {"Quart.INOUT", &TweenEquations::easeInOutQuart},
+        {"Quint.IN", &TweenEquations::easeInQuint}, {"Quint.OUT", &TweenEquations::easeOutQuint}, {"Quint.INOUT", &TweenEquations::easeInOutQuint},
+        {"Circ.IN", &TweenEquations::easeInCirc}, {"Circ.OUT", &TweenEquations::easeOutCirc}, {"Circ.INOUT", &TweenEquations::easeInOutCirc},
+        {"Sine.IN", &TweenEquations::easeInSine}, {"Sine.OUT", &TweenEquations::easeOutSine}, {"Sine.INOUT", &TweenEquations::easeInOutSine},
+        {"Expo.IN", &TweenEquations::easeInExpo}, {"Expo.OUT", &TweenEquations::easeOutExpo}, {"Expo.INOUT", &TweenEquations::easeInOutExpo},
+        {"Back.IN", &TweenEquations::easeInBack}, {"Back.OUT", &TweenEquations::easeOutBack}, {"Back.INOUT", &TweenEquations::easeInOutBack},
+        {"Bounce.IN", &TweenEquations::easeInBounce}, {"Bounce.OUT", &TweenEquations::easeOutBounce}, {"Bounce.INOUT", &TweenEquations::easeInOutBounce},
+        {"Elastic.IN", &TweenEquations::easeInElastic}, {"Elastic.OUT", &TweenEquations::easeOutElastic}, {"Elastic.INOUT", &TweenEquations::easeInOutElastic},
+    };
+    return std::vector<Equation>(equations, equations + sizeof(equations)/sizeof(equations[0]));
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks
+// -----------------------------------------------------------------------------
+
+/**
+ * Cost of a manager update per running tween, against the tween count.
+ */
+static void benchUpdate()
+{
+    int maxCnt = isQuick ? 10000 : 1000000;
+    for (int cnt=1000; cnt<=maxCnt; cnt*=10)
+    {
+        std::vector<float> targets(cnt*2);
+        TweenManager manager;
+        manager.ensureCapacity(cnt);
+        for (int i=0; i<cnt; i++)
+        {
+            manager.add(Tween::to(i+1, 1000.0f, makeAccessor(&targets[i*2], 2)).target(100, 200));
+        }
+        manager.update(0.001f);
+
+        int frames = std::max(3, 1000000/cnt);
+        double time = measure([&]() { for (int f=0; f<frames; f++) manager.update(0.001f); });
+        report("update", format("tweens=%lld", cnt), time*1e9/frames/cnt, "ns/tween");
+
+        manager.clear();
+    }
+}
+
+/**
+ * Cost of an update of 100k tweens all in the middle of an iteration, with
+ * and without the fast path of BaseTween::update().
+ */
+static void benchFastPath()
+{
+    int cnt = 100000;
+    std::vector<float> targets(cnt*2);
+    TweenManager manager;
+    manager.ensureCapacity(cnt);
+    for (int i=0; i<cnt; i++)
+    {
+        manager.add(Tween::to(i+1, 1000.0f, makeAccessor(&targets[i*2], 2)).target(100, 200));
+    }
+    manager.update(0.001f);
+
+    int frames = 10;
+    for (int isOn=1; isOn>=0; isOn--)
+    {
+        BaseTween::setFastPathEnabled(isOn != 0);
+        double time = measure([&]() { for (int f=0; f<frames; f++) manager.update(0.001f); });
+        report("fastPath", isOn ? "tweens=100000,on" : "tweens=100000,off", time*1e9/frames/cnt, "ns/tween");
+    }
+    BaseTween::setFastPathEnabled(true);
+
+    manager.clear();
+}
+
+/**
+ * Cost of an update of a large manager spread over a TweenThreadPool, see
+ * TweenManager#setExecutor(), with 1, 2, 4... threads up to the hardware
+ * concurrency, and at least 4.
+ */
+static void benchUpdateParallel()
+{
+    int maxThreadsCnt = std::max(4, (int)std::thread::hardware_concurrency());
+    int maxCnt = isQuick ? 100000 : 1000000;
+    for (int cnt=100000; cnt<=maxCnt; cnt*=10)
+    {
+        std::vector<float> targets(cnt*2);
+        TweenManager manager;
+        manager.ensureCapacity(cnt);
+        for (int i=0; i<cnt; i++)
+        {
+            manager.add(Tween::to(i+1, 1000.0f, makeAccessor(&targets[i*2], 2)).target(100, 200));
+        }
+        manager.update(0.001f);
+
+        for (int threadsCnt=1; threadsCnt<=maxThreadsCnt; threadsCnt*=2)
+        {
+            TweenThreadPool pool(threadsCnt);
+            manager.setExecutor(&pool);
+            int frames = std::max(3, 1000000/cnt);
+            double time = measure([&]() { for (int f=0; f<frames; f++) manager.update(0.001f); });
+            report("update_parallel", format("tweens=%lld", cnt) + format(",threads=%lld", threadsCnt), time*1e9/frames/cnt, "ns/tween");
+            manager.setExecutor(NULL);
+        }
+
+        manager.clear();
+    }
+}
+
+/**
+ * Cost of an equation call, for all the equations.
+ */
+static void benchEquations()
+{
+    std::vector<Equation> equations = getEquations();
+    int calls = isQuick ? 100000 : 1000000;
+
+    for (int e=0; e<(int)equations.size(); e++)
+    {
+        TweenEquation *equation = equations[e].equation;
+        double time = measure([&]()
+        {
+            float sum = 0;
+            for (int i=0; i<calls; i++) sum += equation->compute((float)i / calls);
+            sink = sum;
+        });
+        report("equation", equations[e].name, time*1e9/calls, "ns/call");
+    }
+}
+
+/**
+ * Cost of a tween update with waypoints, for both path algorithms.
+ */
+static void benchPaths()
+{
+    int cnt = isQuick ? 1000 : 10000;
+    int frames = 100;
+    Tween::setWaypointsLimit(16);
+
+    TweenPath *paths[] = {&TweenPaths::linear, &TweenPaths::catmullRom};
+    const char *names[] = {"linear", "catmullRom"};
+
+    for (int p=0; p<2; p++)
+    {
+        for (int waypointsCnt=1; waypointsCnt<=16; waypointsCnt*=2)
+        {
+            std::vector<float> targets(cnt*3);
+            TweenManager manager;
+            manager.ensureCapacity(cnt);
+            for (int i=0; i<cnt; i++)
+            {
+                Tween &tween = Tween::to(i+1, 1000.0f, makeAccessor(&targets[i*3], 3));
+                for (int w=0; w<waypointsCnt; w++) tween.waypoint((float)w, (float)-w, (float)(w*2));
+                tween.target(100, 200, 300).path(*paths[p]);
+                manager.add(tween);
+            }
+
+            double time = measure([&]() { for (int f=0; f<frames; f++) manager.update(0.001f); });
+            report("path", format((std::string(names[p]) + ",waypoints=%lld").c_str(), waypointsCnt), time*1e9/frames/cnt, "ns/tween");
+
+            manager.clear();
+        }
+    }
+
+    Tween::setWaypointsLimit(0);
+}
+
+/**
+ * Cost of getting and freeing tweens: through the pool alone, then through
+ * a manager, with the global pool and with the manager arena, then from
+ * several threads sharing the pool.
+ */
+static void benchChurn()
+{
+    int cnt = isQuick ? 10000 : 100000;
+    float target[2];
+    std::vector<Tween *> tweens(cnt);
+
+    double time = measure([&]()
+    {
+        for (int i=0; i<cnt; i++) tweens[i] = &Tween::to(1, 1.0f, makeAccessor(target, 2)).target(1, 2);
+        for (int i=0; i<cnt; i++) tweens[i]->free();
+    });
+    report("churn", "pool", time*1e9/cnt, "ns/tween");
+
+    for (int isArena=0; isArena<2; isArena++)
+    {
+        TweenManager manager;
+        manager.ensureCapacity(1024);
+        int perFrame = 1000;
+        int frames = cnt / perFrame;
+
+        time = measure([&]()
+        {
+            for (int f=0; f<frames; f++)
+            {
+                for (int i=0; i<perFrame; i++)
+                {
+                    Tween &tween = isArena ? Tween::to(manager.getArena(), i+1, 0.001f, makeAccessor(target, 2))
+                        : Tween::to(i+1, 0.001f, makeAccessor(target, 2));
+                    manager.add(tween.target(1, 2));
+                }
+                manager.update(0.01f);
+            }
+        });
+        report("churn", isArena ? "manager,arena" : "manager,pool", time*1e9/(frames*perFrame), "ns/tween");
+        manager.clear();
+    }
+
+    // Threads creating and freeing tweens at the same time, by batches
+    // spanning a few magazines of the pool. Reported as the throughput of
+    // all the threads together.
+    int maxThreadsCnt = std::max(4, (int)std::thread::hardware_concurrency());
+    for (int threadsCnt=1; threadsCnt<=maxThreadsCnt; threadsCnt*=2)
+    {
+        time = measure([&]()
+        {
+            std::vector<std::thread> threads;
+            for (int t=0; t<threadsCnt; t++)
+            {
+                threads.push_back(std::thread([cnt]()
+                {
+                    float target[2];
+                    Tween *batch[100];
+                    for (int i=0; i<cnt; i+=100)
+                    {
+                        for (int k=0; k<100; k++) batch[k] = &Tween::to(1, 1.0f, makeAccessor(target, 2)).target(1, 2);
+                        for (int k=0; k<100; k++) batch[k]->free();
+                    }
+                }));
+            }
+            for (int t=0; t<threadsCnt; t++) threads[t].join();
+        });
+        report("churn", format("threads=%lld", threadsCnt), cnt*threadsCnt/time, "tweens/s");
+    }
+}
+
+/**
+ * Cost of killTarget() on a manager, four tweens per target.
+ */
+static void benchKillTarget()
+{
+    int maxCnt = isQuick ? 10000 : 100000;
+    for (int cnt=1000; cnt<=maxCnt; cnt*=10)
+    {
+        std::vector<float> targets(cnt);
+        TweenManager manager;
+        manager.ensureCapacity(cnt);
+        for (int i=0; i<cnt; i++) manager.add(Tween::to(i/4+1, 1000.0f, makeAccessor(&targets[i], 1)).target(1));
+        manager.update(0.001f);
+
+        int calls = 100;
+        int handle = 1;
+        double time = measure([&]() { for (int i=0; i<calls; i++) manager.killTarget(handle++); });
+        report("killTarget", format("tweens=%lld", cnt), time*1e6/calls, "us/call");
+
+        manager.clear();
+    }
+}
+
+/**
+ * Cost of killing, one id at a time, every tween of a manager while they
+ * all still wait for their staggered delays.
+ */
+static void benchKillParked()
+{
+    int maxCnt = isQuick ? 10000 : 100000;
+    for (int cnt=1000; cnt<=maxCnt; cnt*=10)
+    {
+        std::vector<float> targets(cnt);
+        std::vector<TweenId> ids(cnt);
+        std::vector<double> times;
+        for (int run=0; run<(isQuick ? 3 : 7); run++)
+        {
+            TweenManager manager;
+            manager.ensureCapacity(cnt);
+            for (int i=0; i<cnt; i++)
+            {
+                Tween &tween = Tween::to(i+1, 1.0f, makeAccessor(&targets[i], 1)).target(1);
+                tween.delay(1.0f + i*0.001f);
+                manager.add(tween);
+                ids[i] = tween.getId();
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int i=0; i<cnt; i++) manager.kill(ids[i]);
+            times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+            manager.update(0);
+            manager.update(0);
+        }
+        std::sort(times.begin(), times.end());
+        report("killParked", format("tweens=%lld", cnt), times[times.size()/2]*1e9/cnt, "ns/kill");
+    }
+}
+
+class CountingCallback : public TweenCallback
+{
+public:
+    int cnt;
+    CountingCallback() : cnt(0) {}
+    void onEvent(int type, BaseTween *source) { cnt++; }
+};
+
+/**
+ * Cost of a coalescing seek of a parallel timeline, whose tweens all cross
+ * most of their repetitions on the way, firing every event type. Includes the
+ * silent seek back to the start.
+ */
+static void benchSeek()
+{
+    int maxCnt = isQuick ? 10000 : 100000;
+    for (int cnt=1000; cnt<=maxCnt; cnt*=10)
+    {
+        std::vector<float> targets(cnt);
+        CountingCallback callback;
+        TweenManager manager;
+        Timeline &timeline = Timeline::createParallel();
+        for (int i=0; i<cnt; i++)
+        {
+            Tween &tween = Tween::to(i+1, 0.1f, makeAccessor(&targets[i], 1)).target(1);
+            tween.repeatYoyo(20, 0.01f).setCallback(&callback).setCallbackTriggers(TweenCallback::ANY);
+            timeline.push(tween);
+        }
+        manager.add(timeline);
+        manager.update(0);
+
+        double time = measure([&]()
+        {
+            timeline.seek(0);
+            timeline.seek(2.0f, BaseTween::SEEK_COALESCE);
+        });
+        report("seek", format("tweens=%lld", cnt), time*1e9/cnt, "ns/tween");
+        manager.clear();
+    }
+}
+
+/**
+ * Size and cost of a snapshot of the manager, and of its restore.
+ */
+static void benchSnapshot()
+{
+    int cnt = 10000;
+    std::vector<float> targets(cnt*2);
+    TweenManager manager;
+    for (int i=0; i<cnt; i++)
+    {
+        Tween &tween = Tween::to(i+1, 1.0f, makeAccessor(&targets[i*2], 2));
+        manager.add(tween.target(100, 200).delay((float)(i%10) / 10).repeatYoyo(2, 0.1f));
+    }
+    manager.update(0.25f);
+
+    size_t size = manager.snapshot(NULL, 0);
+    std::vector<char> buffer(size);
+    bool isRestored = true;
+
+    // Several of each per run, a single one being too short to time steadily
+    int loopsCnt = 20;
+    double snapshotTime = measure([&]()
+    {
+        for (int i=0; i<loopsCnt; i++) manager.snapshot(buffer.data(), buffer.size());
+    }) / loopsCnt;
+    double restoreTime = measure([&]()
+    {
+        for (int i=0; i<loopsCnt; i++) isRestored = manager.restore(buffer.data(), buffer.size()) && isRestored;
+    }) / loopsCnt;
+
+    report("snapshot", format("tweens=%lld", cnt), (double)size, "bytes");
+    report("snapshot", format("tweens=%lld", cnt), snapshotTime*1e6, "us");
+    report("restore", format("tweens=%lld", cnt), restoreTime*1e6, "us");
+    if (!isRestored)
+    {
+        report("restore", "failed", 1, "error");
+        isFailed = true;
+    }
+
+    manager.clear();
+}
+
+/**
+ * Cost of the tracer on a manager adding and finishing tweens every frame,
+ * each one recording about seven life-cycle events, then of a dump of the
+ * full buffer.
+ */
+static void benchTracer()
+{
+    int cnt = isQuick ? 10000 : 100000;
+    float target[2];
+    TweenTracer tracer(65536);
+
+    for (int isTraced=0; isTraced<2; isTraced++)
+    {
+        TweenManager manager;
+        manager.ensureCapacity(1024);
+        manager.setTracer(isTraced ? &tracer : NULL);
+        int perFrame = 1000;
+        int frames = cnt / perFrame;
+
+        double time = measure([&]()
+        {
+            for (int f=0; f<frames; f++)
+            {
+                for (int i=0; i<perFrame; i++) manager.add(Tween::to(i+1, 0.001f, makeAccessor(target, 2)).target(1, 2));
+                manager.update(0.01f);
+            }
+        });
+        report("tracer", isTraced ? "on" : "off", time*1e9/(frames*perFrame), "ns/tween");
+        manager.clear();
+    }
+
+    std::string json;
+    json.reserve(16*1024*1024);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int eventsCnt = tracer.dump(json);
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("tracer", format("dump,events=%lld", eventsCnt), time*1e6, "us");
+    report("tracer", "dump", (double)json.size(), "bytes");
+}
+
+// -----------------------------------------------------------------------------
+// Checks
+// -----------------------------------------------------------------------------
+
+/**
+ * Counts the allocations of a warmed manager, spawning and updating a mix
+ * of delayed, repeated and nested animations every frame, with a coalescing
+ * seek now and then.
+ */
+static void checkAllocations()
+{
+    static const int TARGETS_CNT = 4096;
+    std::vector<float> targets(TARGETS_CNT*2);
+    std::vector<TweenId> paused;
+    paused.reserve(100000);
+
+    CountingCallback callback;
+    TweenManager manager;
+    TweenEventQueue eventQueue(4096);
+    TweenCommandQueue commandQueue(1024);
+    manager.setEventQueue(&eventQueue, true);
+    manager.setCommandQueue(&commandQueue);
+
+    int frame = 0;
+    int perFrame = 64;
+    auto spawn = [&]()
+    {
+        for (int i=0; i<perFrame; i++)
+        {
+            int n = frame*perFrame + i;
+            float *target = &targets[(n % TARGETS_CNT)*2];
+            switch (n % 6)
+            {
+                case 0:
+                    manager.add(Tween::to(n, 0.5f, makeAccessor(target, 2)).target(1, 2).delay(0.1f));
+                    break;
+                case 1:
+                    manager.add(Tween::to(n, 0.3f, makeAccessor(target, 2)).target(1, 2).repeatYoyo(2, 0.05f)
+                        .setCallback(&callback).setCallbackTriggers(TweenCallback::ANY));
+                    break;
+                case 2:
+                    manager.add(Timeline::createSequence()
+                        .push(Tween::to(n, 0.2f, makeAccessor(target, 2)).target(3, 4))
+                        .pushPause(0.1f)
+                        .beginParallel()
+                            .push(Tween::to(n, 0.2f, makeAccessor(target, 2)).target(5, 6))
+                            .push(Tween::mark())
+                        .end()
+                        .setCallback(&callback));
+                    break;
+                case 3:
+                    manager.add(Tween::to(manager.getArena(), n, 0.4f, makeAccessor(target, 2)).target(7, 8));
+                    break;
+                case 4:
+                    commandQueue.spawn(TweenSpawn::to(n, 0.25f, makeAccessor(target, 2)).target(1, 1).delay(0.05f));
+                    break;
+                case 5:
+                {
+                    Tween &tween = Tween::from(n, 0.35f, makeAccessor(target, 2));
+                    manager.add(tween.target(2, 2));
+                    if (frame % 3 == 0) { manager.pause(tween.getId()); paused.push_back(tween.getId()); }
+                    if (frame % 3 == 1 && !paused.empty()) { manager.resume(paused.back()); paused.pop_back(); }
+                    if (frame % 5 == 0) manager.killTarget(n - 6);
+                    break;
+                }
+            }
+        }
+    };
+
+    // Some frames are coalescing seeks instead of updates
+    auto step = [&]()
+    {
+        if (frame % 10 == 9) manager.seek(manager.getTime() + 1/60.0, BaseTween::SEEK_COALESCE);
+        else manager.update(1/60.0f);
+    };
+
+    int warmupFrames = 400;
+    int frames = isQuick ? 200 : 1000;
+    for (; frame<warmupFrames; frame++) { spawn(); step(); }
+
+    manager.resetStats();
+    long long cnt = countAllocations();
+    for (; frame<warmupFrames+frames; frame++) { spawn(); step(); }
+    cnt = countAllocations() - cnt;
+
+    report("allocations", format("frames=%lld", frames), (double)cnt, "allocations");
+    if (cnt != 0 && isCheck) isFailed = true;
+
+#ifdef TWEEN_ENGINE_STATS
+    // Work of an average frame of the same workload
+    const TweenStats &stats = manager.getTotalStats();
+    report("stats", "visited", (double)stats.visitedCnt/frames, "objects/frame");
+    report("stats", "initialized", (double)stats.initializedCnt/frames, "objects/frame");
+    report("stats", "crossings", (double)stats.crossingCnt/frames, "crossings/frame");
+    report("stats", "reads", (double)stats.readCnt/frames, "calls/frame");
+    report("stats", "writes", (double)stats.writeCnt/frames, "calls/frame");
+    report("stats", "callbacks", (double)stats.callbackCnt/frames, "calls/frame");
+    report("stats", "freed", (double)stats.freedCnt/frames, "objects/frame");
+    report("stats", "freeTime", stats.freeTime*1e6/frames, "us/frame");
+    report("stats", "commandTime", stats.commandTime*1e6/frames, "us/frame");
+    report("stats", "wakeTime", stats.wakeTime*1e6/frames, "us/frame");
+    report("stats", "updateTime", stats.updateTime*1e6/frames, "us/frame");
+    report("stats", "dispatchTime", stats.dispatchTime*1e6/frames, "us/frame");
+#endif
+
+    manager.clear();
+}
+
+// Re-adds the given tween to the manager from the callback of another one
+class ReAddCallback : public TweenCallback
+{
+public:
+    TweenManager *manager;
+    Tween *tween;
+    int readdCnt;
+    ReAddCallback() : manager(NULL), tween(NULL), readdCnt(1) {}
+    void onEvent(int type, BaseTween *source) { for (int i=0; i<readdCnt; i++) manager->add(*tween); }
+};
+
+/**
+ * Re-adds delayed tweens from the COMPLETE callback of another tween, once
+ * they are back in the loop: before and after the callback source in the
+ * update order, twice in a row, forward and through a seek. The loop must
+ * never hold an object twice, and every tween must end at its target.
+ */
+static void checkReAdd()
+{
+    int failedCnt = 0;
+    for (int variant=0; variant<8; variant++)
+    {
+        bool isReAddedFirst = (variant & 1) != 0;
+        int readdCnt = (variant & 2) != 0 ? 2 : 1;
+        bool isSeeking = (variant & 4) != 0;
+
+        float source = 0, target = 0;
+        TweenManager manager;
+        ReAddCallback callback;
+        callback.manager = &manager;
+        callback.readdCnt = readdCnt;
+
+        Tween &delayed = Tween::to(2, 1.0f, makeAccessor(&target, 1)).target(1.0f);
+        delayed.delay(0.15f);
+        callback.tween = &delayed;
+        Tween &trigger = Tween::to(1, 0.1f, makeAccessor(&source, 1)).target(1.0f);
+        trigger.setCallback(&callback);
+
+        if (isReAddedFirst) manager.add(delayed).add(trigger);
+        else manager.add(trigger).add(delayed);
+
+        bool isValid = true;
+        for (int frame=0; frame<40 && isValid; frame++)
+        {
+            if (isSeeking) manager.seek(manager.getTime() + 0.1, BaseTween::SEEK_COALESCE);
+            else manager.update(0.1f);
+
+            std::vector<BaseTween *> objects = manager.getObjects();
+            std::sort(objects.begin(), objects.end());
+            isValid = std::adjacent_find(objects.begin(), objects.end()) == objects.end();
+        }
+        manager.update(0);
+
+        if (!isValid || manager.size() != 0 || source != 1.0f || target != 1.0f) failedCnt++;
+    }
+
+    report("readd", "variants=8", failedCnt == 0 ? 1 : 0, "bool");
+    if (failedCnt > 0 && isCheck) isFailed = true;
+}
+
+// Counts its live copies, to find the accessors never destroyed
+struct CaptureCounter
+{
+    static int liveCnt;
+    CaptureCounter() { liveCnt++; }
+    CaptureCounter(const CaptureCounter &) { liveCnt++; }
+    ~CaptureCounter() { liveCnt--; }
+};
+int CaptureCounter::liveCnt = 0;
+
+/**
+ * Clears a manager holding tweens of its arena in every state: playing,
+ * delayed, paused, removed but not freed yet, and freed back to the arena,
+ * then reuses the arena. Every capture of their accessors must be
+ * destroyed once the manager is.
+ */
+static void checkClear()
+{
+    float target = 0;
+    {
+        CaptureCounter counter;
+        auto accessor = [counter, &target](int mode, float *values)
+        {
+            if (mode == Tween::ACCESSOR_READ) values[0] = target; else target = values[0];
+            return 1;
+        };
+
+        TweenManager manager;
+        for (int i=0; i<40; i++)
+        {
+            Tween &tween = Tween::to(manager.getArena(), i+1, 1.0f, accessor).target(1);
+            if (i % 4 == 1) tween.delay(5);
+            manager.add(tween);
+            if (i % 4 == 2) manager.pause(tween.getId());
+            if (i % 4 == 3) manager.kill(tween.getId());
+        }
+        manager.update(0.1f);
+        Tween::to(manager.getArena(), 100, 1.0f, accessor).free();
+        manager.clear();
+
+        for (int i=0; i<10; i++) manager.add(Tween::to(manager.getArena(), i+1, 1.0f, accessor).target(1));
+        manager.update(0.1f);
+    }
+
+    report("clear", "captures", CaptureCounter::liveCnt, "leaks");
+    if (CaptureCounter::liveCnt != 0 && isCheck) isFailed = true;
+}
+
+/**
+ * Pauses a delayed tween through BaseTween while it waits, then resumes it:
+ * its delay must stop running meanwhile, as for the same tween updated
+ * without manager, and the manager must be idle. Then kills a delayed
+ * tween the same way: it must be gone at the next update.
+ */
+static void checkParked()
+{
+    float managedTarget = 0, target = 0;
+    TweenManager manager;
+    Tween &managed = Tween::to(1, 1.0f, makeAccessor(&managedTarget, 1)).target(100);
+    Tween &reference = Tween::to(1, 1.0f, makeAccessor(&target, 1)).target(100);
+    managed.delay(1.0f);
+    reference.delay(1.0f);
+    manager.add(managed);
+    reference.start();
+
+    for (int frame=0; frame<6; frame++)
+    {
+        if (frame == 1) { managed.pause(); reference.pause(); }
+        if (frame == 5) { managed.resume(); reference.resume(); }
+        float delta = frame < 5 ? 0.25f : 1.0f;
+        manager.update(delta);
+        reference.update(delta);
+    }
+    bool isPauseValid = managedTarget == target && target > 0 && target < 100;
+    report("parked", "pause", isPauseValid ? 1 : 0, "bool");
+    manager.clear();
+    reference.free();
+
+    // Nothing left to wake the host for once the delayed tween is paused
+    Tween &paused = Tween::to(3, 1.0f, makeAccessor(&target, 1)).target(100);
+    manager.add(paused.delay(3600.0f));
+    manager.update(0.1f);
+    paused.pause();
+    bool isIdleValid = manager.nextEventTime() == -1 && manager.isIdle();
+    manager.update(0.1f);
+    isIdleValid = isIdleValid && manager.nextEventTime() == -1 && manager.isIdle() && manager.size() == 1;
+    report("parked", "idle", isIdleValid ? 1 : 0, "bool");
+    manager.clear();
+
+    Tween &killed = Tween::to(2, 1.0f, makeAccessor(&target, 1)).target(100);
+    manager.add(killed.delay(3600.0f));
+    manager.update(0.1f);
+    killed.kill();
+    bool isKillValid = manager.nextEventTime() == -1;
+    manager.update(0.1f);
+    isKillValid = isKillValid && manager.size() == 0 && !manager.containsTarget(2);
+    report("parked", "kill", isKillValid ? 1 : 0, "bool");
+    manager.clear();
+
+    if ((!isPauseValid || !isIdleValid || !isKillValid) && isCheck) isFailed = true;
+}
+
+/**
+ * Digests the equations on a grid, and the values written by a manager
+ * animating every equation with repetitions and yoyos, with uneven deltas.
+ */
+static void checkDeterminism()
+{
+    uint64_t digest = 14695981039346656037ULL;
+    auto add = [&digest](float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        digest = (digest ^ bits) * 1099511628211ULL;
+    };
+
+    std::vector<Equation> equations = getEquations();
+    for (int e=0; e<(int)equations.size(); e++)
+    {
+        for (int i=0; i<=1000; i++) add(equations[e].equation->compute(i / 1000.0f));
+    }
+
+    int perEquation = 8;
+    std::vector<float> targets(equations.size()*perEquation*2);
+    TweenManager manager;
+    for (int e=0; e<(int)equations.size(); e++)
+    {
+        for (int i=0; i<perEquation; i++)
+        {
+            float *target = &targets[(e*perEquation + i)*2];
+            target[0] = (float)i;
+            target[1] = (float)-e;
+            manager.add(Tween::to(e+1, 0.5f + 0.1f*i, makeAccessor(target, 2))
+                .target(10.0f + e, 3.5f*i)
+                .ease(*equations[e].equation)
+                .delay(0.05f*i)
+                .repeatYoyo(3, 0.02f));
+        }
+    }
+    for (int frame=0; frame<300; frame++)
+    {
+        manager.update(frame % 7 == 0 ? 0.0331f : 0.0167f);
+        for (int i=0; i<(int)targets.size(); i++) add(targets[i]);
+    }
+    manager.clear();
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)digest);
+    printf("{\"bench\": \"determinism\", \"case\": \"digest\", \"value\": \"%s\", \"unit\": \"fnv1a64\"}\n", hex);
+
+#if defined(TWEEN_ENGINE_DETERMINISTIC)
+    // Reference digest, the same on every platform
+#if defined(TWEEN_ENGINE_DOUBLE_TIME)
+    const char *expected = "e9bc0f00604d8d1f";
+#else
+    const char *expected = "3eccb5ee30fdd38e";
+#endif
+    bool isMatching = strcmp(hex, expected) == 0;
+    report("determinism", "matches_reference", isMatching ? 1 : 0, "bool");
+    if (!isMatching && isCheck) isFailed = true;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Main
+// -----------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    for (int i=1; i<argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0) isQuick = true;
+        else if (strcmp(argv[i], "--check") == 0) isCheck = true;
+        else if (strcmp(argv[i], "--filter") == 0 && i+1 < argc) filter = argv[++i];
+        else
+        {
+            fprintf(stderr, "Usage: %s [--quick] [--check] [--filter name]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (isEnabled("allocations")) checkAllocations();
+    if (isEnabled("determinism")) checkDeterminism();
+    if (isEnabled("readd")) checkReAdd();
+    if (isEnabled("clear")) checkClear();
+    if (isEnabled("parked")) checkParked();
+
+    if (isEnabled("update")) benchUpdate();
+    if (isEnabled("update_parallel")) benchUpdateParallel();
+    if (isEnabled("fastPath")) benchFastPath();
+    if (isEnabled("equation")) benchEquations();
+    if (isEnabled("path")) benchPaths();
+    if (isEnabled("churn")) benchChurn();
+    if (isEnabled("killTarget")) benchKillTarget();
+    if (isEnabled("killParked")) benchKillParked();
+    if (isEnabled("seek")) benchSeek();
+    if (isEnabled("snapshot") || isEnabled("restore")) benchSnapshot();
+    if (isEnabled("tracer")) benchTracer();
+
+    return isFailed ? 1 : 0;
+}
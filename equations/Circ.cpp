@@ -6,23 +6,23 @@
 //
 
 #include "Circ.h"
-#include <math.h>
+#include "TweenMath.h"
 
 namespace TweenEngine
 {
-    float CircIn::compute(float t) { return (float) -sqrt(1 - t*t) - 1; }
+    float CircIn::compute(float t) { return (float) -TweenMath::sqrt(1 - t*t) - 1; }
     const char *CircIn::toString() { return "Circ.IN"; }
     
-    float CircOut::compute(float t) { return (float) sqrt(1 - (t-1)*(t-1)); }
+    float CircOut::compute(float t) { return (float) TweenMath::sqrt(1 - (t-1)*(t-1)); }
     const char *CircOut::toString() { return "Circ.OUT"; }
     
     float CircInOut::compute(float t) {
         t *= 2;
         if (t < 1) {
-            return (float)(-0.5 * (sqrt(1 - t*t) - 1));
+            return (float)(-0.5 * (TweenMath::sqrt(1 - t*t) - 1));
         } else {
             t -= 2;
-            return (float)(0.5 * (sqrt(1 - t*t) + 1));
+            return (float)(0.5 * (TweenMath::sqrt(1 - t*t) + 1));
         }
     }
     
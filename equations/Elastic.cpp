@@ -9,7 +9,7 @@
 #define _USE_MATH_DEFINES
 #endif
 #include "Elastic.h"
-#include <math.h>
+#include "TweenMath.h"
 
 namespace TweenEngine
 {
@@ -24,10 +24,10 @@ namespace TweenEngine
             a = 1.0f;
             s = p/4.0f;
         } else {
-            s = (float)(p/(2*M_PI) * asin(1/a));
+            s = (float)(p/(2*M_PI) * TweenMath::asin(1/a));
         }
         t -= 1;
-        return -(a*(float)pow(2,10*t) * (float)sin((t-s)*(2*M_PI)/p ));
+        return -(a*(float)TweenMath::exp2(10*t) * (float)TweenMath::sin((t-s)*(2*M_PI)/p ));
     }
     const char *ElasticIn::toString() { return "Elastic.IN"; }
     void ElasticIn::setAmplitude(float a) { this->amplitude = a; this->isAmplitudeSet = true; }
@@ -44,9 +44,9 @@ namespace TweenEngine
             a = 1;
             s = p/4.0f;
         } else {
-            s = (float)(p/(2*M_PI) * asin(1/a));
+            s = (float)(p/(2*M_PI) * TweenMath::asin(1/a));
         }
-        return a*(float)pow(2,-10*t) * (float)sin((t-s)*(2*M_PI)/p ) + 1;
+        return a*(float)TweenMath::exp2(-10*t) * (float)TweenMath::sin((t-s)*(2*M_PI)/p ) + 1;
     }
     const char *ElasticOut::toString() { return "Elastic.OUT"; }
     void ElasticOut::setAmplitude(float a) { this->amplitude = a; this->isAmplitudeSet = true; }
@@ -64,14 +64,14 @@ namespace TweenEngine
             a = 1;
             s = p/4.0f;
         } else {
-            s = (float)(p/(2*M_PI) * asin(1/a));
+            s = (float)(p/(2*M_PI) * TweenMath::asin(1/a));
         }
         if (t < 1) {
             t -= 1;
-            return -0.5f*(a*(float)pow(2,10*t) * (float)sin((t-s)*(2*M_PI)/p));
+            return -0.5f*(a*(float)TweenMath::exp2(10*t) * (float)TweenMath::sin((t-s)*(2*M_PI)/p));
         } else {
             t -= 1;
-            return a*(float)pow(2,-10*t) * (float)sin((t-s)*(2*M_PI)/p)*0.5f + 1;
+            return a*(float)TweenMath::exp2(-10*t) * (float)TweenMath::sin((t-s)*(2*M_PI)/p)*0.5f + 1;
         }
     }
     const char *ElasticInOut::toString() { return "Elastic.INOUT"; }
@@ -9,17 +9,17 @@
 #define _USE_MATH_DEFINES
 #endif
 
-#include <math.h>
 #include "Sine.h"
+#include "TweenMath.h"
 
 namespace TweenEngine
 {
-    float SineIn::compute(float t) { return (float)-cos(t * (M_PI/2)) + 1; }
+    float SineIn::compute(float t) { return (float)-TweenMath::cos(t * (M_PI/2)) + 1; }
     const char *SineIn::toString() { return "Sine.IN"; }
     
-    float SineOut::compute(float t) { return (float)sin(t * (M_PI/2)); }
+    float SineOut::compute(float t) { return (float)TweenMath::sin(t * (M_PI/2)); }
     const char *SineOut::toString() { return "Sine.OUT"; }
     
-    float SineInOut::compute(float t) { return -0.5f * ((float)cos(M_PI*t) - 1); }
+    float SineInOut::compute(float t) { return -0.5f * ((float)TweenMath::cos(M_PI*t) - 1); }
     const char *SineInOut::toString() { return "Sine.INOUT"; }
 }
@@ -5,14 +5,14 @@
 //  Licensed under Apache License 2.0 - http://www.apache.org/licenses/LICENSE-2.0
 //
 
-#include <math.h>
 #include "CatmullRom.h"
 
 namespace TweenEngine
 {
     float CatmullRom::compute(float t, float *points, int pointsCnt)
     {
-		int segment = (int) floor((pointsCnt-1) * t);
+		// Truncation, negative segments are clamped anyway
+		int segment = (int)((pointsCnt-1) * t);
 		segment = segment > 0 ? segment : 0;
 		segment = segment < (pointsCnt-2) ? segment : pointsCnt-2;
         